@@ -1,9 +1,11 @@
 // FileTypeValidator.cpp
 #include "FileTypeValidator.h"
+#include "../Txt/Container_txt.h"
 #include <fstream>
 #include <stdexcept>
 #include <algorithm>
 #include <cctype>
+#include <sys/stat.h>
 
 /*
 How does it work:
@@ -11,6 +13,10 @@ To ensure a file is a valid JPEG, verify its first few bytes (magic number), not
 The first two bytes must be 0xFFD8, which is part of the JPEG file signature.
 
 For TXT, we simply check if the file exists and contains readable text characters.
+
+For COMPRESSED, the file must start with the container magic and carry a version this build reads.
+
+For DIRECTORY, the path only has to name a directory.
 */
 
 // Function to check if a file exists
@@ -33,6 +39,11 @@ std::vector<unsigned char> readHeaderBytes(const std::string &filePath, size_t n
 
 // Function to validate the file type based on the expected type's header bytes
 bool validateFileType(const std::string &filePath, FileType expectedType) {
+    if (expectedType == FileType::DIRECTORY) {
+        struct stat info;
+        return stat(filePath.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+    }
+
     if (!fileExists(filePath)) {
         throw std::invalid_argument("File does not exist.");
     }
@@ -61,6 +72,14 @@ bool validateFileType(const std::string &filePath, FileType expectedType) {
             return true;
         }
 
+        case FileType::COMPRESSED: {
+            std::ifstream file(filePath, std::ios::binary);
+            char header[CONTAINER_MAGIC_SIZE + 2];
+            file.read(header, sizeof(header));
+            int version = containerVersion(header, static_cast<size_t>(file.gcount()));
+            return version >= 1 && version <= CONTAINER_VERSION;
+        }
+
         default:
             throw std::invalid_argument("Unsupported file type.");
     }
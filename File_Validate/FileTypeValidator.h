@@ -9,6 +9,8 @@
 enum class FileType {
     JPEG,
     TXT,
+    COMPRESSED,     // Compresso container written by the txt codecs
+    DIRECTORY,      // Directory tree, packed into a txt archive
     // TO add more functionality later on
 };
 
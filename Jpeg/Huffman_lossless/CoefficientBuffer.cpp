@@ -0,0 +1,40 @@
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include "CoefficientBuffer.h"
+
+void CoefficientBuffer::reset(const std::vector<std::pair<int, int>>& planeSizes) {
+    planes.clear();
+    blocks = 0;
+    for (const auto& size : planeSizes) {
+        if (size.first <= 0 || size.second <= 0) throw std::runtime_error("Invalid plane size.");
+        PlaneLayout layout;
+        layout.width = size.first;
+        layout.height = size.second;
+        layout.blocksX = (size.first + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        layout.blocksY = (size.second + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        layout.firstBlock = blocks;
+        blocks += layout.blockCount();
+        planes.push_back(layout);
+    }
+
+    // Over allocate and align by hand, which needs no platform call; new throws bad_alloc on failure
+    size_t bytes = blocks * BLOCK_VALUES * sizeof(int16_t);
+    size_t space = bytes + COEFFICIENT_ALIGNMENT - 1;
+    storage.reset(new unsigned char[space]);
+    void* memory = storage.get();
+    values = static_cast<int16_t*>(std::align(COEFFICIENT_ALIGNMENT, bytes, memory, space));
+
+    // Zero initialized, so padding and untouched blocks read back as 0
+    std::fill(values, values + blocks * BLOCK_VALUES, 0);
+}
+
+BlockView CoefficientBuffer::plane(size_t plane) {
+    const PlaneLayout& layout = planes[plane];
+    return BlockView(values + layout.firstBlock * BLOCK_VALUES, layout.blockCount());
+}
+
+ConstBlockView CoefficientBuffer::plane(size_t plane) const {
+    const PlaneLayout& layout = planes[plane];
+    return ConstBlockView(values + layout.firstBlock * BLOCK_VALUES, layout.blockCount());
+}
@@ -0,0 +1,86 @@
+#ifndef COEFFICIENT_BUFFER_H
+#define COEFFICIENT_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/*
+Coefficient storage:
+
+All quantized coefficients of an image live in one aligned int16_t allocation, plane after plane
+(Y, Cb, Cr) and inside a plane block after block in raster order, each block being its 64 values
+row major. The encoder quantizes straight into place and the entropy coder walks the buffer
+linearly, instead of one heap allocation per 8x8 block. Quantized coefficients of 8-bit samples
+always fit in 16 bits (the largest is the DC with a quantization step of 1, 8 * 255).
+*/
+
+const int BLOCK_SIZE = 8;
+const size_t BLOCK_VALUES = 64;
+const size_t COEFFICIENT_ALIGNMENT = 64;
+
+// A channel cut into 8x8 blocks, blocks over the right and bottom edges are padded
+struct PlaneLayout {
+    int width;
+    int height;
+    int blocksX;
+    int blocksY;
+    size_t firstBlock;   // Index of its first block in the buffer
+
+    size_t blockCount() const { return static_cast<size_t>(blocksX) * blocksY; }
+};
+
+// Non owning view of consecutive blocks, view[i] points to the 64 values of block i
+template <typename T>
+class BasicBlockView {
+public:
+    BasicBlockView(T* data, size_t blocks) : values(data), blocks(blocks) {}
+
+    // A view of writable blocks converts to a read only one
+    template <typename U>
+    BasicBlockView(const BasicBlockView<U>& other) : values(other.begin()), blocks(other.size()) {}
+
+    size_t size() const { return blocks; }
+    T* operator[](size_t i) const { return values + i * BLOCK_VALUES; }
+
+    // Every value of every block, in storage order
+    T* begin() const { return values; }
+    T* end() const { return values + blocks * BLOCK_VALUES; }
+
+private:
+    T* values;
+    size_t blocks;
+};
+
+typedef BasicBlockView<int16_t> BlockView;
+typedef BasicBlockView<const int16_t> ConstBlockView;
+
+class CoefficientBuffer {
+public:
+    CoefficientBuffer() : values(nullptr), blocks(0) {}
+
+    // One plane per (width, height) in samples, the previous contents are dropped
+    void reset(const std::vector<std::pair<int, int>>& planeSizes);
+
+    size_t planeCount() const { return planes.size(); }
+    const PlaneLayout& layout(size_t plane) const { return planes[plane]; }
+
+    BlockView plane(size_t plane);
+    ConstBlockView plane(size_t plane) const;
+
+    // The whole buffer
+    BlockView all() { return BlockView(values, blocks); }
+    ConstBlockView all() const { return ConstBlockView(values, blocks); }
+
+    size_t blockCount() const { return blocks; }
+
+private:
+    std::vector<PlaneLayout> planes;
+    std::unique_ptr<unsigned char[]> storage;   // COEFFICIENT_ALIGNMENT - 1 bytes larger than the values
+    int16_t* values;                            // First aligned address in storage
+    size_t blocks;
+};
+
+#endif // COEFFICIENT_BUFFER_H
@@ -0,0 +1,419 @@
+#include "ColorConvert.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <immintrin.h>
+#define COLOR_X86
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define COLOR_NEON
+#endif
+
+/*
+Fixed point constants:
+
+FIX_x is x * 2^SCALE_BITS rounded, the weights of each output add up to exactly 1.0 (or 0.0 for
+the chrominance ones), so gray stays gray. The chrominance offset carries ONE_HALF - 1 instead
+of ONE_HALF, as in libjpeg, which keeps Cb and Cr of pure colors at 255 instead of 256.
+*/
+static const int SCALE_BITS = 16;
+static const int ONE_HALF = 1 << (SCALE_BITS - 1);
+static const int CBCR_OFFSET = 128 << SCALE_BITS;
+
+static const int FIX_0_29900 = 19595;
+static const int FIX_0_58700 = 38470;
+static const int FIX_0_11400 = 7471;
+static const int FIX_0_16874 = 11059;
+static const int FIX_0_33126 = 21709;
+static const int FIX_0_50000 = 32768;
+static const int FIX_0_41869 = 27439;
+static const int FIX_0_08131 = 5329;
+
+static const int FIX_1_40200 = 91881;
+static const int FIX_0_34414 = 22554;
+static const int FIX_0_71414 = 46802;
+static const int FIX_1_77200 = 116130;
+
+
+/*
+Scalar kernels:
+
+Also finish the last count % 16 pixels of a row for the vector kernels.
+*/
+static inline uint8_t saturate(int value) {
+    return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+static void rgbToYCbCrScalar(const uint8_t* rgb, uint8_t* Y, uint8_t* Cb, uint8_t* Cr, int count) {
+    for (int i = 0; i < count; ++i) {
+        int R = rgb[i * 3];
+        int G = rgb[i * 3 + 1];
+        int B = rgb[i * 3 + 2];
+        Y[i] = static_cast<uint8_t>((FIX_0_29900 * R + FIX_0_58700 * G + FIX_0_11400 * B + ONE_HALF) >> SCALE_BITS);
+        Cb[i] = static_cast<uint8_t>((-FIX_0_16874 * R - FIX_0_33126 * G + FIX_0_50000 * B
+                                      + CBCR_OFFSET + ONE_HALF - 1) >> SCALE_BITS);
+        Cr[i] = static_cast<uint8_t>((FIX_0_50000 * R - FIX_0_41869 * G - FIX_0_08131 * B
+                                      + CBCR_OFFSET + ONE_HALF - 1) >> SCALE_BITS);
+    }
+}
+
+static void yCbCrToRgbScalar(const uint8_t* Y, const uint8_t* Cb, const uint8_t* Cr, uint8_t* rgb, int count) {
+    for (int i = 0; i < count; ++i) {
+        int y = Y[i];
+        int cb = Cb[i] - 128;
+        int cr = Cr[i] - 128;
+        rgb[i * 3] = saturate(y + ((FIX_1_40200 * cr + ONE_HALF) >> SCALE_BITS));
+        rgb[i * 3 + 1] = saturate(y + ((-FIX_0_34414 * cb - FIX_0_71414 * cr + ONE_HALF) >> SCALE_BITS));
+        rgb[i * 3 + 2] = saturate(y + ((FIX_1_77200 * cb + ONE_HALF) >> SCALE_BITS));
+    }
+}
+
+
+#ifdef COLOR_X86
+/*
+SSE4.1 and AVX2 kernels:
+
+16 pixels are 48 bytes of RGB, three 16 byte loads that byte shuffles split into one vector of
+R, one of G and one of B (and back on the way out). The channels are widened to 32-bit lanes
+for the products, four vectors each with SSE4.1, two with AVX2, and packed back to bytes with
+unsigned saturation, which also does the clamping of the decoder.
+*/
+
+// DEINTERLEAVE[channel][load]: bytes of that channel in each 16 byte load, -1 gives 0
+alignas(16) static const int8_t DEINTERLEAVE[3][3][16] = {
+    {{0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+     {-1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1},
+     {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13}},
+    {{1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+     {-1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1},
+     {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14}},
+    {{2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+     {-1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1},
+     {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15}}
+};
+
+// INTERLEAVE[store][channel]: where each channel's bytes go in each 16 byte store
+alignas(16) static const int8_t INTERLEAVE[3][3][16] = {
+    {{0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1, -1, 5},
+     {-1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1, -1},
+     {-1, -1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1}},
+    {{-1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1, 10, -1},
+     {5, -1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1, 10},
+     {-1, 5, -1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1}},
+    {{-1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1, -1},
+     {-1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1},
+     {10, -1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15}}
+};
+
+__attribute__((target("sse4.1")))
+static inline __m128i shuffleMask(const int8_t* mask) {
+    return _mm_load_si128(reinterpret_cast<const __m128i*>(mask));
+}
+
+__attribute__((target("sse4.1")))
+static inline void loadRgb(const uint8_t* rgb, __m128i* channels) {
+    __m128i loads[3];
+    for (int k = 0; k < 3; ++k) loads[k] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgb + k * 16));
+    for (int c = 0; c < 3; ++c) {
+        channels[c] = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(loads[0], shuffleMask(DEINTERLEAVE[c][0])),
+                                                _mm_shuffle_epi8(loads[1], shuffleMask(DEINTERLEAVE[c][1]))),
+                                   _mm_shuffle_epi8(loads[2], shuffleMask(DEINTERLEAVE[c][2])));
+    }
+}
+
+__attribute__((target("sse4.1")))
+static inline void storeRgb(const __m128i* channels, uint8_t* rgb) {
+    for (int k = 0; k < 3; ++k) {
+        __m128i bytes = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(channels[0], shuffleMask(INTERLEAVE[k][0])),
+                                                  _mm_shuffle_epi8(channels[1], shuffleMask(INTERLEAVE[k][1]))),
+                                     _mm_shuffle_epi8(channels[2], shuffleMask(INTERLEAVE[k][2])));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(rgb + k * 16), bytes);
+    }
+}
+
+__attribute__((target("sse4.1")))
+static inline __m128i scale(__m128i a, int weight) {
+    return _mm_mullo_epi32(a, _mm_set1_epi32(weight));
+}
+
+// (sum + offset) >> SCALE_BITS per lane
+__attribute__((target("sse4.1")))
+static inline __m128i descale(__m128i sum, int offset) {
+    return _mm_srai_epi32(_mm_add_epi32(sum, _mm_set1_epi32(offset)), SCALE_BITS);
+}
+
+// (a * wa + b * wb + c * wc + offset) >> SCALE_BITS per lane
+__attribute__((target("sse4.1")))
+static inline __m128i weigh(__m128i a, int wa, __m128i b, int wb, __m128i c, int wc, int offset) {
+    return descale(_mm_add_epi32(_mm_add_epi32(scale(a, wa), scale(b, wb)), scale(c, wc)), offset);
+}
+
+// 16 bytes into four vectors of 4 lanes
+__attribute__((target("sse4.1")))
+static inline void widen(__m128i bytes, __m128i* lanes) {
+    __m128i zero = _mm_setzero_si128();
+    __m128i low = _mm_unpacklo_epi8(bytes, zero);
+    __m128i high = _mm_unpackhi_epi8(bytes, zero);
+    lanes[0] = _mm_unpacklo_epi16(low, zero);
+    lanes[1] = _mm_unpackhi_epi16(low, zero);
+    lanes[2] = _mm_unpacklo_epi16(high, zero);
+    lanes[3] = _mm_unpackhi_epi16(high, zero);
+}
+
+__attribute__((target("sse4.1")))
+static inline __m128i narrow(const __m128i* lanes) {
+    return _mm_packus_epi16(_mm_packus_epi32(lanes[0], lanes[1]), _mm_packus_epi32(lanes[2], lanes[3]));
+}
+
+__attribute__((target("sse4.1")))
+static void rgbToYCbCrSse41(const uint8_t* rgb, uint8_t* Y, uint8_t* Cb, uint8_t* Cr, int count) {
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i channels[3];
+        loadRgb(rgb + i * 3, channels);
+        __m128i r[4], g[4], b[4], y[4], cb[4], cr[4];
+        widen(channels[0], r);
+        widen(channels[1], g);
+        widen(channels[2], b);
+        for (int k = 0; k < 4; ++k) {
+            y[k] = weigh(r[k], FIX_0_29900, g[k], FIX_0_58700, b[k], FIX_0_11400, ONE_HALF);
+            cb[k] = weigh(r[k], -FIX_0_16874, g[k], -FIX_0_33126, b[k], FIX_0_50000, CBCR_OFFSET + ONE_HALF - 1);
+            cr[k] = weigh(r[k], FIX_0_50000, g[k], -FIX_0_41869, b[k], -FIX_0_08131, CBCR_OFFSET + ONE_HALF - 1);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(Y + i), narrow(y));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(Cb + i), narrow(cb));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(Cr + i), narrow(cr));
+    }
+    rgbToYCbCrScalar(rgb + i * 3, Y + i, Cb + i, Cr + i, count - i);
+}
+
+__attribute__((target("sse4.1")))
+static void yCbCrToRgbSse41(const uint8_t* Y, const uint8_t* Cb, const uint8_t* Cr, uint8_t* rgb, int count) {
+    __m128i center = _mm_set1_epi32(128);
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i y[4], cb[4], cr[4], r[4], g[4], b[4];
+        widen(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Y + i)), y);
+        widen(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Cb + i)), cb);
+        widen(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Cr + i)), cr);
+        for (int k = 0; k < 4; ++k) {
+            cb[k] = _mm_sub_epi32(cb[k], center);
+            cr[k] = _mm_sub_epi32(cr[k], center);
+            r[k] = _mm_add_epi32(y[k], descale(scale(cr[k], FIX_1_40200), ONE_HALF));
+            __m128i green = _mm_add_epi32(scale(cb[k], -FIX_0_34414), scale(cr[k], -FIX_0_71414));
+            g[k] = _mm_add_epi32(y[k], descale(green, ONE_HALF));
+            b[k] = _mm_add_epi32(y[k], descale(scale(cb[k], FIX_1_77200), ONE_HALF));
+        }
+        __m128i channels[3] = {narrow(r), narrow(g), narrow(b)};
+        storeRgb(channels, rgb + i * 3);
+    }
+    yCbCrToRgbScalar(Y + i, Cb + i, Cr + i, rgb + i * 3, count - i);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i scale(__m256i a, int weight) {
+    return _mm256_mullo_epi32(a, _mm256_set1_epi32(weight));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i descale(__m256i sum, int offset) {
+    return _mm256_srai_epi32(_mm256_add_epi32(sum, _mm256_set1_epi32(offset)), SCALE_BITS);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i weigh(__m256i a, int wa, __m256i b, int wb, __m256i c, int wc, int offset) {
+    return descale(_mm256_add_epi32(_mm256_add_epi32(scale(a, wa), scale(b, wb)), scale(c, wc)), offset);
+}
+
+// 16 bytes into two vectors of 8 lanes
+__attribute__((target("avx2")))
+static inline void widen(__m128i bytes, __m256i* lanes) {
+    lanes[0] = _mm256_cvtepu8_epi32(bytes);
+    lanes[1] = _mm256_cvtepu8_epi32(_mm_unpackhi_epi64(bytes, bytes));
+}
+
+// The 32 to 16 bit pack works within 128-bit halves, the permute puts the halves back in order
+__attribute__((target("avx2")))
+static inline __m128i narrow(const __m256i* lanes) {
+    __m256i words = _mm256_permute4x64_epi64(_mm256_packus_epi32(lanes[0], lanes[1]), _MM_SHUFFLE(3, 1, 2, 0));
+    return _mm_packus_epi16(_mm256_castsi256_si128(words), _mm256_extracti128_si256(words, 1));
+}
+
+__attribute__((target("avx2")))
+static void rgbToYCbCrAvx2(const uint8_t* rgb, uint8_t* Y, uint8_t* Cb, uint8_t* Cr, int count) {
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i channels[3];
+        loadRgb(rgb + i * 3, channels);
+        __m256i r[2], g[2], b[2], y[2], cb[2], cr[2];
+        widen(channels[0], r);
+        widen(channels[1], g);
+        widen(channels[2], b);
+        for (int k = 0; k < 2; ++k) {
+            y[k] = weigh(r[k], FIX_0_29900, g[k], FIX_0_58700, b[k], FIX_0_11400, ONE_HALF);
+            cb[k] = weigh(r[k], -FIX_0_16874, g[k], -FIX_0_33126, b[k], FIX_0_50000, CBCR_OFFSET + ONE_HALF - 1);
+            cr[k] = weigh(r[k], FIX_0_50000, g[k], -FIX_0_41869, b[k], -FIX_0_08131, CBCR_OFFSET + ONE_HALF - 1);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(Y + i), narrow(y));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(Cb + i), narrow(cb));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(Cr + i), narrow(cr));
+    }
+    rgbToYCbCrScalar(rgb + i * 3, Y + i, Cb + i, Cr + i, count - i);
+}
+
+__attribute__((target("avx2")))
+static void yCbCrToRgbAvx2(const uint8_t* Y, const uint8_t* Cb, const uint8_t* Cr, uint8_t* rgb, int count) {
+    __m256i center = _mm256_set1_epi32(128);
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i y[2], cb[2], cr[2], r[2], g[2], b[2];
+        widen(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Y + i)), y);
+        widen(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Cb + i)), cb);
+        widen(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Cr + i)), cr);
+        for (int k = 0; k < 2; ++k) {
+            cb[k] = _mm256_sub_epi32(cb[k], center);
+            cr[k] = _mm256_sub_epi32(cr[k], center);
+            r[k] = _mm256_add_epi32(y[k], descale(scale(cr[k], FIX_1_40200), ONE_HALF));
+            __m256i green = _mm256_add_epi32(scale(cb[k], -FIX_0_34414), scale(cr[k], -FIX_0_71414));
+            g[k] = _mm256_add_epi32(y[k], descale(green, ONE_HALF));
+            b[k] = _mm256_add_epi32(y[k], descale(scale(cb[k], FIX_1_77200), ONE_HALF));
+        }
+        __m128i channels[3] = {narrow(r), narrow(g), narrow(b)};
+        storeRgb(channels, rgb + i * 3);
+    }
+    yCbCrToRgbScalar(Y + i, Cb + i, Cr + i, rgb + i * 3, count - i);
+}
+#endif
+
+
+#ifdef COLOR_NEON
+/*
+NEON kernels:
+
+vld3q / vst3q split and merge the 16 pixels of RGB. Each half of 8 is widened to two vectors of
+4 lanes, unsigned for the encoder (its sums never go negative), signed for the decoder, and
+narrowed with saturating moves.
+*/
+static inline uint16x4_t weighUnsigned(uint32x4_t sum, uint16x4_t r, int wr, uint16x4_t g, int wg,
+                                       uint16x4_t b, int wb) {
+    // Negative weights subtract, in this order the offset keeps the sum from ever going below 0
+    if (wb >= 0) sum = vmlal_n_u16(sum, b, wb); else sum = vmlsl_n_u16(sum, b, -wb);
+    if (wr >= 0) sum = vmlal_n_u16(sum, r, wr); else sum = vmlsl_n_u16(sum, r, -wr);
+    if (wg >= 0) sum = vmlal_n_u16(sum, g, wg); else sum = vmlsl_n_u16(sum, g, -wg);
+    return vshrn_n_u32(sum, SCALE_BITS);
+}
+
+static inline uint8x8_t convertHalf(uint16x8_t r, uint16x8_t g, uint16x8_t b, int wr, int wg, int wb,
+                                    int offset) {
+    uint32x4_t start = vdupq_n_u32(static_cast<uint32_t>(offset));
+    uint16x4_t low = weighUnsigned(start, vget_low_u16(r), wr, vget_low_u16(g), wg, vget_low_u16(b), wb);
+    uint16x4_t high = weighUnsigned(start, vget_high_u16(r), wr, vget_high_u16(g), wg, vget_high_u16(b), wb);
+    return vqmovn_u16(vcombine_u16(low, high));
+}
+
+static inline uint8x16_t convertChannel(const uint16x8_t* r, const uint16x8_t* g, const uint16x8_t* b,
+                                        int wr, int wg, int wb, int offset) {
+    return vcombine_u8(convertHalf(r[0], g[0], b[0], wr, wg, wb, offset),
+                       convertHalf(r[1], g[1], b[1], wr, wg, wb, offset));
+}
+
+static void rgbToYCbCrNeon(const uint8_t* rgb, uint8_t* Y, uint8_t* Cb, uint8_t* Cr, int count) {
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint8x16x3_t pixels = vld3q_u8(rgb + i * 3);
+        uint16x8_t r[2] = {vmovl_u8(vget_low_u8(pixels.val[0])), vmovl_u8(vget_high_u8(pixels.val[0]))};
+        uint16x8_t g[2] = {vmovl_u8(vget_low_u8(pixels.val[1])), vmovl_u8(vget_high_u8(pixels.val[1]))};
+        uint16x8_t b[2] = {vmovl_u8(vget_low_u8(pixels.val[2])), vmovl_u8(vget_high_u8(pixels.val[2]))};
+        vst1q_u8(Y + i, convertChannel(r, g, b, FIX_0_29900, FIX_0_58700, FIX_0_11400, ONE_HALF));
+        vst1q_u8(Cb + i, convertChannel(r, g, b, -FIX_0_16874, -FIX_0_33126, FIX_0_50000,
+                                        CBCR_OFFSET + ONE_HALF - 1));
+        vst1q_u8(Cr + i, convertChannel(r, g, b, FIX_0_50000, -FIX_0_41869, -FIX_0_08131,
+                                        CBCR_OFFSET + ONE_HALF - 1));
+    }
+    rgbToYCbCrScalar(rgb + i * 3, Y + i, Cb + i, Cr + i, count - i);
+}
+
+// y + ((cb * wcb + cr * wcr + ONE_HALF) >> SCALE_BITS) for 4 lanes
+static inline int32x4_t addChroma(int32x4_t y, int32x4_t cb, int wcb, int32x4_t cr, int wcr) {
+    int32x4_t sum = vmlaq_n_s32(vmlaq_n_s32(vdupq_n_s32(ONE_HALF), cb, wcb), cr, wcr);
+    return vaddq_s32(y, vshrq_n_s32(sum, SCALE_BITS));
+}
+
+static inline uint8x8_t rgbHalf(int16x8_t y, int16x8_t cb, int16x8_t cr, int wcb, int wcr) {
+    int32x4_t low = addChroma(vmovl_s16(vget_low_s16(y)), vmovl_s16(vget_low_s16(cb)), wcb,
+                              vmovl_s16(vget_low_s16(cr)), wcr);
+    int32x4_t high = addChroma(vmovl_s16(vget_high_s16(y)), vmovl_s16(vget_high_s16(cb)), wcb,
+                               vmovl_s16(vget_high_s16(cr)), wcr);
+    return vqmovn_u16(vcombine_u16(vqmovun_s32(low), vqmovun_s32(high)));
+}
+
+static inline uint8x16_t rgbChannel(const int16x8_t* y, const int16x8_t* cb, const int16x8_t* cr, int wcb, int wcr) {
+    return vcombine_u8(rgbHalf(y[0], cb[0], cr[0], wcb, wcr), rgbHalf(y[1], cb[1], cr[1], wcb, wcr));
+}
+
+static inline int16x8_t widenSigned(uint8x8_t bytes, int center) {
+    return vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(bytes)), vdupq_n_s16(static_cast<int16_t>(center)));
+}
+
+static void yCbCrToRgbNeon(const uint8_t* Y, const uint8_t* Cb, const uint8_t* Cr, uint8_t* rgb, int count) {
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint8x16_t yBytes = vld1q_u8(Y + i);
+        uint8x16_t cbBytes = vld1q_u8(Cb + i);
+        uint8x16_t crBytes = vld1q_u8(Cr + i);
+        int16x8_t y[2] = {widenSigned(vget_low_u8(yBytes), 0), widenSigned(vget_high_u8(yBytes), 0)};
+        int16x8_t cb[2] = {widenSigned(vget_low_u8(cbBytes), 128), widenSigned(vget_high_u8(cbBytes), 128)};
+        int16x8_t cr[2] = {widenSigned(vget_low_u8(crBytes), 128), widenSigned(vget_high_u8(crBytes), 128)};
+
+        uint8x16x3_t pixels;
+        pixels.val[0] = rgbChannel(y, cb, cr, 0, FIX_1_40200);
+        pixels.val[1] = rgbChannel(y, cb, cr, -FIX_0_34414, -FIX_0_71414);
+        pixels.val[2] = rgbChannel(y, cb, cr, FIX_1_77200, 0);
+        vst3q_u8(rgb + i * 3, pixels);
+    }
+    yCbCrToRgbScalar(Y + i, Cb + i, Cr + i, rgb + i * 3, count - i);
+}
+#endif
+
+
+/*
+Runtime dispatch:
+
+The kernels are chosen on the first call and kept for the life of the process.
+*/
+namespace {
+
+struct ColorKernels {
+    const char* name;
+    void (*forward)(const uint8_t*, uint8_t*, uint8_t*, uint8_t*, int);
+    void (*inverse)(const uint8_t*, const uint8_t*, const uint8_t*, uint8_t*, int);
+};
+
+ColorKernels detectKernels() {
+#if defined(COLOR_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return ColorKernels{"avx2", rgbToYCbCrAvx2, yCbCrToRgbAvx2};
+    if (__builtin_cpu_supports("sse4.1")) return ColorKernels{"sse4.1", rgbToYCbCrSse41, yCbCrToRgbSse41};
+#elif defined(COLOR_NEON)
+    return ColorKernels{"neon", rgbToYCbCrNeon, yCbCrToRgbNeon};
+#endif
+    return ColorKernels{"scalar", rgbToYCbCrScalar, yCbCrToRgbScalar};
+}
+
+const ColorKernels& kernels() {
+    static const ColorKernels selected = detectKernels();
+    return selected;
+}
+
+} // namespace
+
+void rgbToYCbCrRow(const uint8_t* rgb, uint8_t* Y, uint8_t* Cb, uint8_t* Cr, int count) {
+    kernels().forward(rgb, Y, Cb, Cr, count);
+}
+
+void yCbCrToRgbRow(const uint8_t* Y, const uint8_t* Cb, const uint8_t* Cr, uint8_t* rgb, int count) {
+    kernels().inverse(Y, Cb, Cr, rgb, count);
+}
+
+const char* colorKernel() {
+    return kernels().name;
+}
@@ -0,0 +1,33 @@
+#ifndef COLOR_CONVERT_H
+#define COLOR_CONVERT_H
+
+#include <cstdint>
+
+/*
+Color conversion:
+
+JFIF YCbCr, computed as libjpeg does (jccolor / jdcolor) in 16-bit fixed point with rounding, so
+every kernel gives the same bytes:
+Y = 0.299R + 0.587G + 0.114B
+Cb = 128 - 0.16874R - 0.33126G + 0.5B
+Cr = 128 + 0.5R - 0.41869G - 0.08131B
+
+R = Y + 1.402(Cr - 128)
+G = Y - 0.34414(Cb - 128) - 0.71414(Cr - 128)
+B = Y + 1.772(Cb - 128)
+
+The kernels work on rows of interleaved RGB and are picked once at runtime like the DCT ones:
+AVX2 or SSE4.1 on x86, NEON on ARM64, 16 pixels per iteration widened to 32-bit lanes and
+narrowed back with saturating packs, and a scalar loop for the rest of a row or other CPUs.
+*/
+
+// Converts count RGB pixels into count samples of each of Y, Cb and Cr
+void rgbToYCbCrRow(const uint8_t* rgb, uint8_t* Y, uint8_t* Cb, uint8_t* Cr, int count);
+
+// Converts count samples of each of Y, Cb and Cr into count RGB pixels, clamped to 0..255
+void yCbCrToRgbRow(const uint8_t* Y, const uint8_t* Cb, const uint8_t* Cr, uint8_t* rgb, int count);
+
+// Name of the kernels in use: "avx2", "sse4.1", "neon" or "scalar"
+const char* colorKernel();
+
+#endif // COLOR_CONVERT_H
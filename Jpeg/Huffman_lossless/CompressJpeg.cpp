@@ -18,6 +18,15 @@ JPEG compression is a lossy compression technique. The main steps in JPEG compre
 #include <map>
 #include <string>
 #include <fstream>
+#include <stdexcept>
+#include <algorithm>
+#include <utility>
+#include "CoefficientBuffer.h"
+#include "ColorConvert.h"
+#include "Dct.h"
+#include "Sampling.h"
+#include "Symbols.h"
+#include "../../Thread_Pool/ThreadPool.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "lib/stb_image.h"
@@ -61,123 +70,185 @@ Image loadImage(const std::string& path) {
 }
 
 /*
-Color Space Conversion:
+Color Space Conversion and Subsampling:
 
-RGB to YCbCr conversion using the following formulas:
-Y = 0.299R + 0.587G + 0.114B
-Cb = 128 - 0.168736R - 0.331264G + 0.5B
-Cr = 128 + 0.5R - 0.418688G - 0.081312B
+RGB to YCbCr conversion with the fixed point kernels of ColorConvert.h, a row at a time.
+
+The chrominance channels (Cb and Cr) are then subsampled (see Sampling.h): in 4:2:0 each 2x2
+group of samples is averaged into one, in 4:2:2 each horizontal pair, 4:4:4 keeps them all.
+A group over the right or bottom edge of the image repeats its last sample.
+
+The image is converted one stripe at a time into small buffers that hold just that stripe, never
+into planes of the whole image. Their rows are padded to whole blocks by repeating the last
+column, and the rows below the image repeat its last row, so every block is a plain 8x8 copy.
 */
-struct YCbCr {
+struct Stripe {
+    int lumaStride, lumaRows;       // Y samples per row and rows, whole blocks
+    int chromaStride, chromaRows;   // Same for the subsampled Cb and Cr
     std::vector<uint8_t> Y, Cb, Cr;
+
+    Stripe(int lumaStride, int lumaRows, int chromaStride, int chromaRows)
+        : lumaStride(lumaStride), lumaRows(lumaRows), chromaStride(chromaStride), chromaRows(chromaRows),
+          Y(static_cast<size_t>(lumaStride) * lumaRows),
+          Cb(static_cast<size_t>(chromaStride) * chromaRows),
+          Cr(static_cast<size_t>(chromaStride) * chromaRows) {}
 };
 
-YCbCr rgbToYCbCr(const Image& img) {
-    YCbCr ycbcr = {std::vector<uint8_t>(img.width * img.height),
-                   std::vector<uint8_t>(img.width * img.height),
-                   std::vector<uint8_t>(img.width * img.height)};
+// Repeats the last sample of a row up to the stride
+void padRow(uint8_t* row, int width, int stride) {
+    std::fill(row + width, row + stride, row[width - 1]);
+}
+
+// Repeats the last row up to the padded height
+void padRows(std::vector<uint8_t>& samples, int stride, int rows) {
+    for (size_t offset = static_cast<size_t>(rows) * stride; offset < samples.size(); offset += stride) {
+        std::copy(samples.begin() + (offset - stride), samples.begin() + offset, samples.begin() + offset);
+    }
+}
 
-    for (size_t i = 0; i < img.data.size(); i += 3) {
-        uint8_t R = img.data[i];
-        uint8_t G = img.data[i + 1];
-        uint8_t B = img.data[i + 2];
+// Converts and subsamples image rows [firstRow, endRow) into the stripe, firstRow starts a group of chroma rows
+void rgbToYCbCr(const Image& img, int firstRow, int endRow, Subsampling subsampling, Stripe& stripe) {
+    int h = horizontalFactor(subsampling);
+    int v = verticalFactor(subsampling);
+    int chromaWidth = (img.width + h - 1) / h;
+
+    // Full resolution Cb and Cr of the rows averaged together, with a spare sample for odd widths
+    size_t rowSize = static_cast<size_t>(img.width) + 1;
+    std::vector<uint8_t> cbRows(rowSize * v), crRows(rowSize * v);
+
+    for (int y = firstRow; y < endRow; ++y) {
+        int row = y - firstRow;
+        bool groupDone = (row + 1) % v == 0 || y + 1 == endRow; // An odd last row is averaged with itself
+        const uint8_t* rgb = img.data.data() + static_cast<size_t>(y) * img.width * 3;
+        uint8_t* Y = stripe.Y.data() + static_cast<size_t>(row) * stripe.lumaStride;
+        uint8_t* Cb = stripe.Cb.data() + static_cast<size_t>(row / v) * stripe.chromaStride;
+        uint8_t* Cr = stripe.Cr.data() + static_cast<size_t>(row / v) * stripe.chromaStride;
+
+        if (h == 1) {
+            rgbToYCbCrRow(rgb, Y, Cb, Cr, img.width);
+        } else {
+            uint8_t* cb = cbRows.data() + (row % v) * rowSize;
+            uint8_t* cr = crRows.data() + (row % v) * rowSize;
+            rgbToYCbCrRow(rgb, Y, cb, cr, img.width);
+            cb[img.width] = cb[img.width - 1];
+            cr[img.width] = cr[img.width - 1];
+            if (groupDone) {
+                downsampleRow(cbRows.data(), cb, Cb, chromaWidth);
+                downsampleRow(crRows.data(), cr, Cr, chromaWidth);
+            }
+        }
 
-        ycbcr.Y[i / 3] = static_cast<uint8_t>(0.299 * R + 0.587 * G + 0.114 * B);
-        ycbcr.Cb[i / 3] = static_cast<uint8_t>(128 - 0.168736 * R - 0.331264 * G + 0.5 * B);
-        ycbcr.Cr[i / 3] = static_cast<uint8_t>(128 + 0.5 * R - 0.418688 * G - 0.081312 * B);
+        padRow(Y, img.width, stripe.lumaStride);
+        if (groupDone) {
+            padRow(Cb, chromaWidth, stripe.chromaStride);
+            padRow(Cr, chromaWidth, stripe.chromaStride);
+        }
     }
 
-    return ycbcr;
+    int chromaRows = (endRow - firstRow + v - 1) / v;
+    padRows(stripe.Y, stripe.lumaStride, endRow - firstRow);
+    padRows(stripe.Cb, stripe.chromaStride, chromaRows);
+    padRows(stripe.Cr, stripe.chromaStride, chromaRows);
 }
 
 /*
-Subsampling:
+Block Splitting
 
-Reduce the resolution of the chrominance channels (Cb and Cr) by 
-taking every alternate pixel (4:2:0 subsampling)
+Copy the 8x8 block at column bx of a padded stripe buffer for DCT processing.
 */
-
-std::vector<uint8_t> subsampleChannel(const std::vector<uint8_t>& channel, int width, int height) {
-    std::vector<uint8_t> subsampled((width / 2) * (height / 2));
-
-    for (int y = 0; y < height; y += 2) {
-        for (int x = 0; x < width; x += 2) {
-            subsampled[(y / 2) * (width / 2) + (x / 2)] = channel[y * width + x];
+void extractBlock(const uint8_t* samples, int stride, int bx, int* block) {
+    for (int y = 0; y < BLOCK_SIZE; ++y) {
+        const uint8_t* row = samples + static_cast<size_t>(y) * stride + bx * BLOCK_SIZE;
+        for (int x = 0; x < BLOCK_SIZE; ++x) {
+            block[y * BLOCK_SIZE + x] = row[x];
         }
     }
-    return subsampled;
 }
 
 /*
-Block Splitting
+Discrete Cosine Transform (DCT):
 
-Divide the image into 8x8 blocks for DCT processing
+Separable transforms of Dct.h: the fixed point one by default, whose coefficients are the same
+on every platform, or the AAN float one. Both leave a scale on the coefficients that quantize()
+takes out together with the table.
 */
-std::vector<std::vector<int>> splitIntoBlocks(const std::vector<uint8_t>& channel, int width, int height) {
-    // The block size for DCT
-    const int blockSize = 8;
-    
-    // Number of blocks in the width and height of the image
-    int numBlocksX = (width + blockSize - 1) / blockSize;
-    int numBlocksY = height / blockSize;
-
-    // Vector to hold the blocks
-    std::vector<std::vector<int>> blocks;
-
-    for (int by = 0; by < numBlocksY; ++by) {
-        for (int bx = 0; bx < numBlocksX; ++bx) {
-            std::vector<int> block(blockSize * blockSize);
-            for (int y = 0; y < blockSize; ++y) {
-                for (int x = 0; x < blockSize; ++x) {
-                    int index = (by * blockSize + y) * width + (bx * blockSize + x);
-                    block[y * blockSize + x] = channel[index];
-                }
-            }
-            blocks.push_back(block);
-        }
-    }
 
-    return blocks;
+void applyDCT(int* block) {
+    forwardDCTInt(block, block);
 }
 
+void applyDCT(const int* block, float* coefficients) {
+    forwardDCT(block, coefficients);
+}
+
+
 /*
-Discrete Cosine Transform (DCT):
+Quantization:
+
+Divide the transformed coefficients by the quantization table and round them. The fixed point
+coefficients are 8 times the DCT, so they are divided by 8 * quantTable[i] with integer
+rounding; the float ones are multiplied by the divisors of quantDivisors() (quantization step
+and AAN scale folded together).
 
-Implementing the DCT using the standard formula.
+Y uses the luminance table, Cb and Cr the chrominance one. Both are the example tables of the
+JPEG standard (Annex K) scaled to the quality as the IJG library does: quality 50 keeps them,
+lower qualities multiply them by 50 / quality and higher ones by (100 - quality) / 50, with
+every step kept in 1..255 so that it fits a byte of the header.
 */
 
-void applyDCT(std::vector<int>& block) {
-    std::vector<double> temp(64);
-    for (int u = 0; u < 8; ++u) {
-        for (int v = 0; v < 8; ++v) {
-            double sum = 0;
-            for (int x = 0; x < 8; x++) {
-                for (int y = 0; y < 8; y++) {
-                    double coeff = block[y * 8 + x];
-                    sum += coeff * cos(((2 * x + 1) * u * M_PI) / 16.0) *
-                           cos(((2 * y + 1) * v * M_PI) / 16.0);
-                }
-            }
-            double cu = (u == 0) ? 1 / sqrt(2.0) : 1.0;
-            double cv = (v == 0) ? 1 / sqrt(2.0) : 1.0;
-            temp[u * 8 + v] = 0.25 * cu * cv * sum;
-        }
+std::vector<int> scaleQuantTable(const std::vector<int>& table, int quality) {
+    quality = std::min(std::max(quality, 1), 100);
+    int scale = quality < 50 ? 5000 / quality : 200 - quality * 2;
+
+    std::vector<int> scaled(table.size());
+    for (size_t i = 0; i < table.size(); ++i) {
+        scaled[i] = std::min(std::max((table[i] * scale + 50) / 100, 1), 255);
+    }
+    return scaled;
+}
+
+void quantize(const int* coefficients, const std::vector<int>& quantTable, int16_t* block) {
+    for (size_t i = 0; i < BLOCK_VALUES; ++i) {
+        int divisor = quantTable[i] * 8;
+        int value = coefficients[i];
+        block[i] = static_cast<int16_t>(value < 0 ? -((divisor / 2 - value) / divisor) : (value + divisor / 2) / divisor);
     }
-    for (int i = 0; i < 64; ++i) {
-        block[i] = round(temp[i]);
+}
+
+void quantize(const float* coefficients, const std::vector<float>& divisors, int16_t* block) {
+    for (size_t i = 0; i < BLOCK_VALUES; ++i) {
+        block[i] = static_cast<int16_t>(std::lround(coefficients[i] * divisors[i]));
     }
 }
 
 
+
 /*
-Quantization:
+Transform a channel:
 
-Divide the transformed coefficients by a quantization table and round them.
+Split, transform and quantize the block rows [firstRow, endRow) of a channel, whose samples
+start at the top of the padded stripe buffer, straight into their place in the coefficient buffer.
 */
 
-void quantize(std::vector<int>& block, const std::vector<int>& quantTable) {
-    for (size_t i = 0; i < block.size(); ++i) {
-        block[i] = round(block[i] / static_cast<double>(quantTable[i]));
+void transformPlane(const std::vector<uint8_t>& samples, int stride, const PlaneLayout& plane, BlockView blocks,
+                    int firstRow, int endRow, const std::vector<int>& quantTable, DctMethod method) {
+    std::vector<float> divisors = quantDivisors(quantTable);
+    alignas(32) int block[BLOCK_VALUES];
+    alignas(32) float coefficients[BLOCK_VALUES];
+
+    for (int by = firstRow; by < endRow; ++by) {
+        const uint8_t* rows = samples.data() + static_cast<size_t>(by - firstRow) * BLOCK_SIZE * stride;
+        for (int bx = 0; bx < plane.blocksX; ++bx) {
+            int16_t* quantized = blocks[static_cast<size_t>(by) * plane.blocksX + bx];
+            extractBlock(rows, stride, bx, block);
+            if (method == DCT_FLOAT) {
+                applyDCT(block, coefficients);
+                quantize(coefficients, divisors, quantized);
+            } else {
+                applyDCT(block);
+                quantize(block, quantTable, quantized);
+            }
+        }
     }
 }
 
@@ -186,17 +257,67 @@ void quantize(std::vector<int>& block, const std::vector<int>& quantTable) {
 /*
 Entropy Encoding:
 
-Using Huffman encoding
+Using Huffman encoding of the JPEG symbols of Symbols.h: the blocks of each plane in raster
+order, every block as its DC symbol then its AC symbols, each symbol followed by the raw bits
+of its coefficient. DC and AC symbols have a Huffman tree each.
 */
 
-std::map<int, int> buildFrequencyTable(const std::vector<std::vector<int>>& blocks) {
-    std::map<int, int> frequencyTable;
+// Symbols fit a byte
+const size_t SYMBOL_COUNT = 256;
+
+// Count of every symbol, indexed by the symbol
+typedef std::vector<uint32_t> Histogram;
+
+// Calls emit(symbol, value) for the AC symbols of a block in order, value being the coefficient the symbol
+// stands for (0 for ZRL and EOB)
+template <typename Emit>
+void scanAcSymbols(const int16_t* block, Emit emit) {
+    int run = 0;
+    for (size_t k = 1; k < BLOCK_VALUES; ++k) {
+        int value = block[ZIGZAG[k]];
+        if (value == 0) {
+            ++run;
+            continue;
+        }
+        for (; run > MAX_RUN; run -= MAX_RUN + 1) emit(ZRL, 0);
+        emit((run << 4) | magnitudeCategory(value), value);
+        run = 0;
+    }
+    if (run > 0) emit(EOB, 0);
+}
 
-    for (const auto& block : blocks) {
-        for (int coeff : block) {
-            frequencyTable[coeff]++;
+// Adds the AC symbols of the blocks [first, end) to the counts
+void countAcSymbols(ConstBlockView blocks, size_t first, size_t end, Histogram& histogram) {
+    for (size_t b = first; b < end; ++b) {
+        scanAcSymbols(blocks[b], [&](int symbol, int) { histogram[symbol]++; });
+    }
+}
+
+// Counts the DC symbols, which depend on the previous block, so unlike the AC ones they are not counted per stripe
+Histogram countDcSymbols(const CoefficientBuffer& coefficients) {
+    Histogram histogram(SYMBOL_COUNT, 0);
+    for (size_t plane = 0; plane < coefficients.planeCount(); ++plane) {
+        ConstBlockView blocks = coefficients.plane(plane);
+        int previousDC = 0;
+        for (size_t b = 0; b < blocks.size(); ++b) {
+            histogram[magnitudeCategory(blocks[b][0] - previousDC)]++;
+            previousDC = blocks[b][0];
         }
     }
+    return histogram;
+}
+
+// Merge the histograms
+std::map<int, int> buildFrequencyTable(const std::vector<Histogram>& histograms) {
+    std::vector<uint64_t> totals(SYMBOL_COUNT, 0);
+    for (const Histogram& histogram : histograms) {
+        for (size_t i = 0; i < histogram.size(); ++i) totals[i] += histogram[i];
+    }
+
+    std::map<int, int> frequencyTable;
+    for (size_t i = 0; i < totals.size(); ++i) {
+        if (totals[i] > 0) frequencyTable[static_cast<int>(i)] = static_cast<int>(totals[i]);
+    }
 
     return frequencyTable;
 }
@@ -210,6 +331,11 @@ Node* buildHuffmanTree(const std::map<int, int>& frequencyTable) {
         pq.push(new Node(pair.first, pair.second));
     }
 
+    // A lone symbol still needs a one bit code, pair it with an unused one
+    if (pq.size() == 1) {
+        pq.push(new Node(pq.top()->value == 0 ? 1 : 0, 0));
+    }
+
     while (pq.size() > 1) {
         Node* left = pq.top(); pq.pop();
         Node* right = pq.top(); pq.pop();
@@ -232,39 +358,96 @@ void freeHuffmanTree(Node* root) {
     }
 }
 
-void generateCodes(Node* root, const std::string& code, std::map<int, std::string>& huffmanCodes) {
+// A Huffman code, the path from the root as the length low bits of bits (0 = left)
+struct HuffmanCode {
+    uint64_t bits;
+    int length;
+};
+
+void generateCodes(Node* root, HuffmanCode code, std::map<int, HuffmanCode>& huffmanCodes) {
     if (!root) return;
 
     if (!root->left && !root->right) { // Leaf node (no children)
         huffmanCodes[root->value] = code;
+        return;
+    }
+    if (code.length == 64) {
+        throw std::runtime_error("Huffman code longer than 64 bits.");
     }
 
-    generateCodes(root->left, code + "0", huffmanCodes);
-    generateCodes(root->right, code + "1", huffmanCodes);
+    generateCodes(root->left, {code.bits << 1, code.length + 1}, huffmanCodes);
+    generateCodes(root->right, {(code.bits << 1) | 1, code.length + 1}, huffmanCodes);
 }
 
-std::map<int, std::string> getHuffmanCodes(Node* root) {
-    std::map<int, std::string> huffmanCodes;
-    generateCodes(root, "", huffmanCodes);
+std::map<int, HuffmanCode> getHuffmanCodes(Node* root) {
+    std::map<int, HuffmanCode> huffmanCodes;
+    generateCodes(root, {0, 0}, huffmanCodes);
     return huffmanCodes;
 }
 
-std::string encodeBlocks(const std::vector<std::vector<int>>& blocks, const std::map<int, std::string>& huffmanCodes) {
-    std::string encodedData;
+// Packs bits most significant first into 64-bit words, the layout BitReader in DecompressJpeg.cpp reads
+struct BitWriter {
+    std::vector<uint64_t> words;
+    uint64_t buffer;
+    int bitCount;
 
-    for (const auto& block : blocks) {
-        for (int coeff : block) {
-            if (huffmanCodes.find(coeff) == huffmanCodes.end()) {
-                throw std::runtime_error("Missing Huffman code for coefficient: " + std::to_string(coeff));
-            }
-            else{
-                encodedData += huffmanCodes.at(coeff);
-            }
+    BitWriter() : buffer(0), bitCount(0) {}
+
+    // Appends the count low bits of bits (count <= 64), most significant first
+    void writeBits(uint64_t bits, int count) {
+        if (count == 0) return;
+        if (count < 64) bits &= (uint64_t(1) << count) - 1;
+
+        int free = 64 - bitCount;
+        if (count < free) {
+            buffer = (buffer << count) | bits;
+            bitCount += count;
+            return;
         }
+        int rest = count - free;
+        words.push_back((free == 64 ? 0 : buffer << free) | (bits >> rest));
+        buffer = rest ? bits & ((uint64_t(1) << rest) - 1) : 0;
+        bitCount = rest;
+    }
+
+    // Pads the last word with zeros
+    void flush() {
+        if (bitCount > 0) words.push_back(buffer << (64 - bitCount));
+        buffer = 0;
+        bitCount = 0;
+    }
+};
+
+// Appends the code of a symbol and the magnitude bits of the value it stands for
+void appendSymbol(BitWriter& writer, const std::map<int, HuffmanCode>& huffmanCodes, int symbol, int value) {
+    auto code = huffmanCodes.find(symbol);
+    if (code == huffmanCodes.end()) {
+        throw std::runtime_error("Missing Huffman code for symbol: " + std::to_string(symbol));
     }
+    writer.writeBits(code->second.bits, code->second.length);
+
+    int size = magnitudeCategory(value);
+    writer.writeBits(static_cast<uint64_t>(magnitudeBits(value, size)), size);
+}
 
+std::vector<uint64_t> encodeBlocks(const CoefficientBuffer& coefficients, const std::map<int, HuffmanCode>& dcCodes,
+                                   const std::map<int, HuffmanCode>& acCodes) {
+    BitWriter writer;
+
+    for (size_t plane = 0; plane < coefficients.planeCount(); ++plane) {
+        ConstBlockView blocks = coefficients.plane(plane);
+        int previousDC = 0;
+        for (size_t b = 0; b < blocks.size(); ++b) {
+            const int16_t* block = blocks[b];
+            int difference = block[0] - previousDC;
+            previousDC = block[0];
+            appendSymbol(writer, dcCodes, magnitudeCategory(difference), difference);
+            scanAcSymbols(block, [&](int symbol, int value) { appendSymbol(writer, acCodes, symbol, value); });
+        }
+    }
 
-    return encodedData;
+    writer.flush();
+    return std::move(writer.words);
 }
 
 void saveHuffmanTree(Node* root, std::ofstream& file) {
@@ -282,103 +465,134 @@ void saveHuffmanTree(Node* root, std::ofstream& file) {
 }
 
 
-void saveEncodedData(const std::string& encodedData, Node* huffmanTree, const std::string& outputFile) {
+void saveEncodedData(const std::vector<uint64_t>& encodedData, Node* dcTree, Node* acTree, int width, int height,
+                     Subsampling subsampling, const std::vector<std::vector<int>>& quantTables,
+                     const std::string& outputFile) {
     std::ofstream file(outputFile, std::ios::binary);
     if (!file) {
         throw std::runtime_error("Failed to open output file.");
     }
 
-    // Step 1: Save Huffman tree in compact format
-    saveHuffmanTree(huffmanTree, file);
-
-    // To ensure clear separation between the Huffman tree and encoded data maybe use a end tree marker
+    // Step 0: Save the image size and the chroma subsampling, the decoder derives the plane layout from them
+    file.write(reinterpret_cast<const char*>(&width), sizeof(width));
+    file.write(reinterpret_cast<const char*>(&height), sizeof(height));
+    file.put(static_cast<char>(subsampling));
 
-    // Step 2: Save encoded data with optimized bit packing
-    uint64_t buffer = 0;
-    int bitCount = 0;
+    // Save the luminance and chrominance quantization tables, one byte per step
+    for (const std::vector<int>& table : quantTables) {
+        for (int step : table) file.put(static_cast<char>(step));
+    }
 
-    for (char bit : encodedData) {
-        buffer = (buffer << 1) | (bit - '0');
-        ++bitCount;
+    // Step 1: Save the DC and AC Huffman trees in compact format
+    saveHuffmanTree(dcTree, file);
+    saveHuffmanTree(acTree, file);
 
-        if (bitCount == 64) {
-            file.write(reinterpret_cast<char*>(&buffer), sizeof(buffer));
-            buffer = 0;
-            bitCount = 0;
-        }
-    }
+    // To ensure clear separation between the Huffman tree and encoded data maybe use a end tree marker
 
-    if (bitCount > 0) {
-        buffer <<= (64 - bitCount);
-        file.write(reinterpret_cast<char*>(&buffer), sizeof(buffer));
-    }
+    // Step 2: Save the encoded data, already packed into 64-bit words by BitWriter
+    file.write(reinterpret_cast<const char*>(encodedData.data()),
+               static_cast<std::streamsize>(encodedData.size() * sizeof(uint64_t)));
 
     file.close();
 }
 
 
-void compressJPEG(const std::vector<std::vector<int>>& quantizedBlocks, const std::string& outputFile) {
-    // Step 1: Build frequency table
-    auto frequencyTable = buildFrequencyTable(quantizedBlocks);
+void compressJPEG(const CoefficientBuffer& coefficients, const std::vector<Histogram>& histograms,
+                  int width, int height, Subsampling subsampling, const std::vector<std::vector<int>>& quantTables,
+                  const std::string& outputFile) {
+    // Step 1: Build frequency tables of the DC and AC symbols
+    auto dcFrequencyTable = buildFrequencyTable({countDcSymbols(coefficients)});
+    auto acFrequencyTable = buildFrequencyTable(histograms);
 
-    // Step 2: Build Huffman tree
-    Node* huffmanTree = buildHuffmanTree(frequencyTable);
+    // Step 2: Build Huffman trees
+    Node* dcTree = buildHuffmanTree(dcFrequencyTable);
+    Node* acTree = buildHuffmanTree(acFrequencyTable);
 
     // Step 3: Generate Huffman codes
-    auto huffmanCodes = getHuffmanCodes(huffmanTree);
+    auto dcCodes = getHuffmanCodes(dcTree);
+    auto acCodes = getHuffmanCodes(acTree);
 
     // Step 4: Encode the blocks
-    std::string encodedData = encodeBlocks(quantizedBlocks, huffmanCodes);
-    std::cout << "encodedData success" << std::endl;
+    std::vector<uint64_t> encodedData = encodeBlocks(coefficients, dcCodes, acCodes);
 
     // Step 5: Save the encoded data
-    saveEncodedData(encodedData, huffmanTree, outputFile);
+    saveEncodedData(encodedData, dcTree, acTree, width, height, subsampling, quantTables, outputFile);
+    freeHuffmanTree(dcTree);
+    freeHuffmanTree(acTree);
 
     std::cout << "Compression completed. Output saved to " << outputFile << std::endl;
 }
 
-bool compressJpeg(const std::string& inputPath, const std::string& outputPath, int quality){
+/*
+Stripes:
+
+A stripe is one MCU row, the image rows that give one block row of Cb and Cr: 16 rows and two
+block rows of Y in 4:2:0, 8 rows and one block row of Y otherwise.
+Each stripe is converted, subsampled, transformed and quantized in one pass through its own
+small sample buffers, reading only its own image rows and writing only its own blocks, so the
+stripes run in any order on the thread pool, each counting its AC symbols into its own
+histogram. Besides the image and the coefficients, memory is a few stripes per thread.
+*/
+
+int mcuHeight(Subsampling subsampling) {
+    return BLOCK_SIZE * verticalFactor(subsampling);
+}
 
+void encodeStripe(const Image& img, int stripe, Subsampling subsampling, CoefficientBuffer& coefficients,
+                  const std::vector<std::vector<int>>& quantTables, DctMethod method, Histogram& histogram) {
+    int firstRow = stripe * mcuHeight(subsampling);
+    int endRow = std::min(firstRow + mcuHeight(subsampling), img.height);
+
+    // Block rows of the stripe in each plane
+    int blockFirst[3], blockEnd[3];
+    for (size_t plane = 0; plane < coefficients.planeCount(); ++plane) {
+        int rowsPerStripe = plane == 0 ? verticalFactor(subsampling) : 1;
+        blockFirst[plane] = stripe * rowsPerStripe;
+        blockEnd[plane] = std::min(blockFirst[plane] + rowsPerStripe, coefficients.layout(plane).blocksY);
+    }
 
-    std::cout << "Starting JPEG compression..." << std::endl;
+    const PlaneLayout& luma = coefficients.layout(0);
+    const PlaneLayout& chroma = coefficients.layout(1);
+    Stripe samples(luma.blocksX * BLOCK_SIZE, (blockEnd[0] - blockFirst[0]) * BLOCK_SIZE,
+                   chroma.blocksX * BLOCK_SIZE, (blockEnd[1] - blockFirst[1]) * BLOCK_SIZE);
+    rgbToYCbCr(img, firstRow, endRow, subsampling, samples);
+
+    // Coefficients of the stripe, one contiguous run per plane
+    const std::vector<uint8_t>* channels[] = {&samples.Y, &samples.Cb, &samples.Cr};
+    histogram.assign(SYMBOL_COUNT, 0);
+    for (size_t plane = 0; plane < coefficients.planeCount(); ++plane) {
+        const PlaneLayout& layout = coefficients.layout(plane);
+        int stride = plane == 0 ? samples.lumaStride : samples.chromaStride;
+        BlockView blocks = coefficients.plane(plane);
+        const std::vector<int>& quantTable = quantTables[plane == 0 ? 0 : 1];
+        transformPlane(*channels[plane], stride, layout, blocks, blockFirst[plane], blockEnd[plane], quantTable, method);
+        countAcSymbols(blocks, static_cast<size_t>(blockFirst[plane]) * layout.blocksX,
+                       static_cast<size_t>(blockEnd[plane]) * layout.blocksX, histogram);
+    }
+}
 
-    // Input and output file paths
-    std::string inputFile = "Images/testSmall.jpeg";  
+bool compressJpeg(const std::string& inputPath, const std::string& outputPath, int quality, DctMethod method,
+                  unsigned threads, Subsampling subsampling){
 
-    // Next test on a bigger image
-    // std::string inputFile = "Images/test4.jpeg";  
 
-    std::string outputFile = "output.jc"; 
+    std::cout << "Starting JPEG compression..." << std::endl;
+
+    std::string inputFile = inputPath;
+    std::string outputFile = outputPath;
 
     try {
         // Step 1: Load the image
         Image img = loadImage(inputFile);
         std::cout << "Image loaded successfully: " << img.width << "x" << img.height << std::endl;
 
-        // Step 2: Convert to YCbCr color space
-        YCbCr ycbcr = rgbToYCbCr(img);
-        std::cout << "Color space conversion completed." << std::endl;
-
-        // Step 3: Subsample the chrominance channels
-        std::vector<uint8_t> subsampledCb = subsampleChannel(ycbcr.Cb, img.width, img.height);
-        std::vector<uint8_t> subsampledCr = subsampleChannel(ycbcr.Cr, img.width, img.height);
-        std::cout << "Subsampling completed." << std::endl;
-
-        // Step 4: Split channels into 8x8 blocks
-        auto yBlocks = splitIntoBlocks(ycbcr.Y, img.width, img.height);
-        auto cbBlocks = splitIntoBlocks(subsampledCb, img.width / 2, img.height / 2);
-        auto crBlocks = splitIntoBlocks(subsampledCr, img.width / 2, img.height / 2);
-        std::cout << "Block splitting completed." << std::endl;
+        // Step 2: One coefficient buffer for the whole image, the samples only ever exist a stripe at a time
+        int chromaWidth = (img.width + horizontalFactor(subsampling) - 1) / horizontalFactor(subsampling);
+        int chromaHeight = (img.height + verticalFactor(subsampling) - 1) / verticalFactor(subsampling);
+        CoefficientBuffer coefficients;
+        coefficients.reset({{img.width, img.height}, {chromaWidth, chromaHeight}, {chromaWidth, chromaHeight}});
 
-        // Step 5: Apply DCT to each block
-        for (auto& block : yBlocks) applyDCT(block);
-        for (auto& block : cbBlocks) applyDCT(block);
-        for (auto& block : crBlocks) applyDCT(block);
-        std::cout << "Discrete Cosine Transform (DCT) applied to all blocks." << std::endl;
-
-        // Step 6: Quantize the blocks
-
-        std::vector<int> quantTable = { 16,11,12,14,12,10,16,14,
+        // Step 3: Quantization tables for the quality, luminance then chrominance
+        std::vector<int> lumaQuantTable = { 16,11,12,14,12,10,16,14,
                 13,14,18,17,16,19,24,40,
                 26,24,22,22,24,49,35,37,
                 29,40,58,51,61,60,57,51,
@@ -387,6 +601,18 @@ bool compressJpeg(const std::string& inputPath, const std::string& outputPath, i
                 95,98,103,104,103,62,77,113,
                 121,112,100,120,92,101,103,99 };
 
+        std::vector<int> chromaQuantTable = { 17,18,24,47,99,99,99,99,
+                18,21,26,66,99,99,99,99,
+                24,26,56,99,99,99,99,99,
+                47,66,99,99,99,99,99,99,
+                99,99,99,99,99,99,99,99,
+                99,99,99,99,99,99,99,99,
+                99,99,99,99,99,99,99,99,
+                99,99,99,99,99,99,99,99 };
+
+        std::vector<std::vector<int>> quantTables = {scaleQuantTable(lumaQuantTable, quality),
+                                                     scaleQuantTable(chromaQuantTable, quality)};
+
         // std::vector<int> quantTableAggressive = {
         //         32, 22, 20, 32, 48, 80, 102, 122,
         //         24, 24, 28, 38, 52, 116, 120, 110,
@@ -409,20 +635,24 @@ bool compressJpeg(const std::string& inputPath, const std::string& outputPath, i
         //         288, 368, 380, 392, 448, 400, 412, 396
         //     };
 
-        for (auto& block : yBlocks) quantize(block, quantTable);
-        for (auto& block : cbBlocks) quantize(block, quantTable);
-        for (auto& block : crBlocks) quantize(block, quantTable);
-        std::cout << "Quantization completed." << std::endl;
-
-        // Combine all blocks for compression
-        std::vector<std::vector<int>> allBlocks = yBlocks;
-        allBlocks.insert(allBlocks.end(), cbBlocks.begin(), cbBlocks.end());
-        allBlocks.insert(allBlocks.end(), crBlocks.begin(), crBlocks.end());
-
-        std::cout << "Combined successfully" << std::endl;
-
-        // Step 7: Compress the blocks
-        compressJPEG(allBlocks, outputFile);
+        // Step 4: Convert to YCbCr, subsample the chrominance channels, split into 8x8 blocks, apply DCT
+        // and quantize, one stripe per task
+        ThreadPool pool(threads);
+        int stripes = (img.height + mcuHeight(subsampling) - 1) / mcuHeight(subsampling);
+        std::vector<Histogram> histograms(stripes);
+        for (int stripe = 0; stripe < stripes; ++stripe) {
+            pool.submit([&, stripe]() {
+                encodeStripe(img, stripe, subsampling, coefficients, quantTables, method, histograms[stripe]);
+            });
+        }
+        pool.wait();
+        std::cout << "Color conversion (" << colorKernel() << " kernels), subsampling (" << samplingKernel()
+                  << " kernels), DCT (" << dctKernel() << " kernels) and quantization applied to "
+                  << coefficients.blockCount() << " blocks in " << stripes << " stripes on " << pool.size()
+                  << " thread(s)." << std::endl;
+
+        // Step 5: Compress the blocks
+        compressJPEG(coefficients, histograms, img.width, img.height, subsampling, quantTables, outputFile);
 
         std::cout << "JPEG compression completed successfully." << std::endl;
 
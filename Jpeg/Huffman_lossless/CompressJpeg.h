@@ -3,15 +3,21 @@
 
 #include <string>
 #include <vector>
+#include "Dct.h"
+#include "Sampling.h"
 
 // Function to compress a JPEG image file.
 // Parameters:
 // - inputPath: Path to the input JPEG image file.
 // - outputPath: Path to save the compressed JPEG image file.
-// - quality: Compression quality (1-100, where 100 is the highest quality).
+// - quality: Compression quality (1-100, where 100 is the highest quality), scales the quantization tables.
+// - method: DCT implementation (see Dct.h), the fixed point one gives the same file everywhere.
+// - threads: Workers for the per stripe stages, 0 uses every core.
+// - subsampling: Resolution of the chroma channels (see Sampling.h).
 // Returns:
 // - true if compression was successful, false otherwise.
-bool compressJpeg(const std::string& inputPath, const std::string& outputPath, int quality);
+bool compressJpeg(const std::string& inputPath, const std::string& outputPath, int quality,
+                  DctMethod method = DCT_ISLOW, unsigned threads = 0, Subsampling subsampling = SUBSAMPLING_420);
 
 
 #endif // COMPRESS_JPEG_H
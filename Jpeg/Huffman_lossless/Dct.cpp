@@ -0,0 +1,590 @@
+#include <cmath>
+#include "Dct.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <immintrin.h>
+#define DCT_AVX2
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define DCT_NEON
+#endif
+
+const double AAN_SCALE[8] = {
+    1.0, 1.387039845, 1.306562965, 1.175875602,
+    1.0, 0.785694958, 0.541196100, 0.275899379
+};
+
+/*
+One dimensional passes:
+
+Transform the 8 values at d[0], d[stride], ... d[7 * stride] in place. T is float, or a SIMD
+vector of floats (GCC and Clang vector types take the same operators), which then runs one
+independent transform per lane.
+*/
+template <typename T>
+static inline void aanForward(T* d, int stride) {
+    T tmp0 = d[0] + d[7 * stride];
+    T tmp7 = d[0] - d[7 * stride];
+    T tmp1 = d[1 * stride] + d[6 * stride];
+    T tmp6 = d[1 * stride] - d[6 * stride];
+    T tmp2 = d[2 * stride] + d[5 * stride];
+    T tmp5 = d[2 * stride] - d[5 * stride];
+    T tmp3 = d[3 * stride] + d[4 * stride];
+    T tmp4 = d[3 * stride] - d[4 * stride];
+
+    // Even part
+    T tmp10 = tmp0 + tmp3;
+    T tmp13 = tmp0 - tmp3;
+    T tmp11 = tmp1 + tmp2;
+    T tmp12 = tmp1 - tmp2;
+
+    d[0] = tmp10 + tmp11;
+    d[4 * stride] = tmp10 - tmp11;
+
+    T z1 = (tmp12 + tmp13) * 0.707106781f;
+    d[2 * stride] = tmp13 + z1;
+    d[6 * stride] = tmp13 - z1;
+
+    // Odd part
+    tmp10 = tmp4 + tmp5;
+    tmp11 = tmp5 + tmp6;
+    tmp12 = tmp6 + tmp7;
+
+    T z5 = (tmp10 - tmp12) * 0.382683433f;
+    T z2 = tmp10 * 0.541196100f + z5;
+    T z4 = tmp12 * 1.306562965f + z5;
+    T z3 = tmp11 * 0.707106781f;
+
+    T z11 = tmp7 + z3;
+    T z13 = tmp7 - z3;
+
+    d[5 * stride] = z13 + z2;
+    d[3 * stride] = z13 - z2;
+    d[1 * stride] = z11 + z4;
+    d[7 * stride] = z11 - z4;
+}
+
+template <typename T>
+static inline void aanInverse(T* d, int stride) {
+    // Even part
+    T tmp0 = d[0];
+    T tmp1 = d[2 * stride];
+    T tmp2 = d[4 * stride];
+    T tmp3 = d[6 * stride];
+
+    T tmp10 = tmp0 + tmp2;
+    T tmp11 = tmp0 - tmp2;
+    T tmp13 = tmp1 + tmp3;
+    T tmp12 = (tmp1 - tmp3) * 1.414213562f - tmp13;
+
+    tmp0 = tmp10 + tmp13;
+    tmp3 = tmp10 - tmp13;
+    tmp1 = tmp11 + tmp12;
+    tmp2 = tmp11 - tmp12;
+
+    // Odd part
+    T tmp4 = d[1 * stride];
+    T tmp5 = d[3 * stride];
+    T tmp6 = d[5 * stride];
+    T tmp7 = d[7 * stride];
+
+    T z13 = tmp6 + tmp5;
+    T z10 = tmp6 - tmp5;
+    T z11 = tmp4 + tmp7;
+    T z12 = tmp4 - tmp7;
+
+    tmp7 = z11 + z13;
+    tmp11 = (z11 - z13) * 1.414213562f;
+
+    T z5 = (z10 + z12) * 1.847759065f;
+    tmp10 = z5 - z12 * 1.082392200f;
+    tmp12 = z5 - z10 * 2.613125930f;
+
+    tmp6 = tmp12 - tmp7;
+    tmp5 = tmp11 - tmp6;
+    tmp4 = tmp10 - tmp5;
+
+    d[0] = tmp0 + tmp7;
+    d[7 * stride] = tmp0 - tmp7;
+    d[1 * stride] = tmp1 + tmp6;
+    d[6 * stride] = tmp1 - tmp6;
+    d[2 * stride] = tmp2 + tmp5;
+    d[5 * stride] = tmp2 - tmp5;
+    d[3 * stride] = tmp3 + tmp4;
+    d[4 * stride] = tmp3 - tmp4;
+}
+
+
+/*
+Fixed point passes (islow):
+
+The Loeffler-Ligtenberg-Moschytz factorization libjpeg ships as jfdctint / jidctint, 12
+multiplies per 1-D pass with the constants in 13 fractional bits. The first pass keeps
+PASS1_BITS extra bits of precision and the second one removes them, everything rounds with
+DESCALE. The forward output is 8 times the DCT, the inverse takes dequantized coefficients.
+Only integer adds, multiplies and shifts are involved, so every kernel and every compiler
+produces the same values. T is int or a SIMD vector of 32-bit ints.
+*/
+static const int CONST_BITS = 13;
+static const int PASS1_BITS = 2;
+
+static const int FIX_0_298631336 = 2446;
+static const int FIX_0_390180644 = 3196;
+static const int FIX_0_541196100 = 4433;
+static const int FIX_0_765366865 = 6270;
+static const int FIX_0_899976223 = 7373;
+static const int FIX_1_175875602 = 9633;
+static const int FIX_1_501321110 = 12299;
+static const int FIX_1_847759065 = 15137;
+static const int FIX_1_961570560 = 16069;
+static const int FIX_2_053119869 = 16819;
+static const int FIX_2_562915447 = 20995;
+static const int FIX_3_072711026 = 25172;
+
+// Shift right by n rounding to nearest (a macro, vector arguments would change the ABI)
+#define DESCALE(x, n) (((x) + (1 << ((n) - 1))) >> (n))
+
+template <bool First, typename T>
+static inline void islowForward(T* d, int stride) {
+    const int shift = First ? CONST_BITS - PASS1_BITS : CONST_BITS + PASS1_BITS;
+
+    T tmp0 = d[0] + d[7 * stride];
+    T tmp7 = d[0] - d[7 * stride];
+    T tmp1 = d[1 * stride] + d[6 * stride];
+    T tmp6 = d[1 * stride] - d[6 * stride];
+    T tmp2 = d[2 * stride] + d[5 * stride];
+    T tmp5 = d[2 * stride] - d[5 * stride];
+    T tmp3 = d[3 * stride] + d[4 * stride];
+    T tmp4 = d[3 * stride] - d[4 * stride];
+
+    // Even part
+    T tmp10 = tmp0 + tmp3;
+    T tmp13 = tmp0 - tmp3;
+    T tmp11 = tmp1 + tmp2;
+    T tmp12 = tmp1 - tmp2;
+
+    if (First) {
+        d[0] = (tmp10 + tmp11) << PASS1_BITS;
+        d[4 * stride] = (tmp10 - tmp11) << PASS1_BITS;
+    } else {
+        d[0] = DESCALE(tmp10 + tmp11, PASS1_BITS);
+        d[4 * stride] = DESCALE(tmp10 - tmp11, PASS1_BITS);
+    }
+
+    T z1 = (tmp12 + tmp13) * FIX_0_541196100;
+    d[2 * stride] = DESCALE(z1 + tmp13 * FIX_0_765366865, shift);
+    d[6 * stride] = DESCALE(z1 + tmp12 * -FIX_1_847759065, shift);
+
+    // Odd part
+    z1 = tmp4 + tmp7;
+    T z2 = tmp5 + tmp6;
+    T z3 = tmp4 + tmp6;
+    T z4 = tmp5 + tmp7;
+    T z5 = (z3 + z4) * FIX_1_175875602;
+
+    tmp4 = tmp4 * FIX_0_298631336;
+    tmp5 = tmp5 * FIX_2_053119869;
+    tmp6 = tmp6 * FIX_3_072711026;
+    tmp7 = tmp7 * FIX_1_501321110;
+    z1 = z1 * -FIX_0_899976223;
+    z2 = z2 * -FIX_2_562915447;
+    z3 = z3 * -FIX_1_961570560 + z5;
+    z4 = z4 * -FIX_0_390180644 + z5;
+
+    d[7 * stride] = DESCALE(tmp4 + z1 + z3, shift);
+    d[5 * stride] = DESCALE(tmp5 + z2 + z4, shift);
+    d[3 * stride] = DESCALE(tmp6 + z2 + z3, shift);
+    d[1 * stride] = DESCALE(tmp7 + z1 + z4, shift);
+}
+
+template <bool First, typename T>
+static inline void islowInverse(T* d, int stride) {
+    // The second pass also divides by 8
+    const int shift = First ? CONST_BITS - PASS1_BITS : CONST_BITS + PASS1_BITS + 3;
+
+    // Even part
+    T z2 = d[2 * stride];
+    T z3 = d[6 * stride];
+    T z1 = (z2 + z3) * FIX_0_541196100;
+    T tmp2 = z1 + z3 * -FIX_1_847759065;
+    T tmp3 = z1 + z2 * FIX_0_765366865;
+
+    z2 = d[0];
+    z3 = d[4 * stride];
+    T tmp0 = (z2 + z3) << CONST_BITS;
+    T tmp1 = (z2 - z3) << CONST_BITS;
+
+    T tmp10 = tmp0 + tmp3;
+    T tmp13 = tmp0 - tmp3;
+    T tmp11 = tmp1 + tmp2;
+    T tmp12 = tmp1 - tmp2;
+
+    // Odd part
+    tmp0 = d[7 * stride];
+    tmp1 = d[5 * stride];
+    tmp2 = d[3 * stride];
+    tmp3 = d[1 * stride];
+
+    z1 = tmp0 + tmp3;
+    z2 = tmp1 + tmp2;
+    z3 = tmp0 + tmp2;
+    T z4 = tmp1 + tmp3;
+    T z5 = (z3 + z4) * FIX_1_175875602;
+
+    tmp0 = tmp0 * FIX_0_298631336;
+    tmp1 = tmp1 * FIX_2_053119869;
+    tmp2 = tmp2 * FIX_3_072711026;
+    tmp3 = tmp3 * FIX_1_501321110;
+    z1 = z1 * -FIX_0_899976223;
+    z2 = z2 * -FIX_2_562915447;
+    z3 = z3 * -FIX_1_961570560 + z5;
+    z4 = z4 * -FIX_0_390180644 + z5;
+
+    tmp0 = tmp0 + z1 + z3;
+    tmp1 = tmp1 + z2 + z4;
+    tmp2 = tmp2 + z2 + z3;
+    tmp3 = tmp3 + z1 + z4;
+
+    d[0] = DESCALE(tmp10 + tmp3, shift);
+    d[7 * stride] = DESCALE(tmp10 - tmp3, shift);
+    d[1 * stride] = DESCALE(tmp11 + tmp2, shift);
+    d[6 * stride] = DESCALE(tmp11 - tmp2, shift);
+    d[2 * stride] = DESCALE(tmp12 + tmp1, shift);
+    d[5 * stride] = DESCALE(tmp12 - tmp1, shift);
+    d[3 * stride] = DESCALE(tmp13 + tmp0, shift);
+    d[4 * stride] = DESCALE(tmp13 - tmp0, shift);
+}
+
+
+/*
+Scalar kernels:
+
+Columns first, then rows, the order the vector kernels run in as well. The integer ones may run
+in place.
+*/
+static void forwardScalar(const int* samples, float* coefficients) {
+    for (int i = 0; i < 64; ++i) coefficients[i] = static_cast<float>(samples[i]);
+    for (int col = 0; col < 8; ++col) aanForward(coefficients + col, 8);
+    for (int row = 0; row < 8; ++row) aanForward(coefficients + row * 8, 1);
+}
+
+static void inverseScalar(const float* coefficients, int* samples) {
+    float workspace[64];
+    for (int i = 0; i < 64; ++i) workspace[i] = coefficients[i];
+    for (int col = 0; col < 8; ++col) aanInverse(workspace + col, 8);
+    for (int row = 0; row < 8; ++row) aanInverse(workspace + row * 8, 1);
+    for (int i = 0; i < 64; ++i) samples[i] = static_cast<int>(std::lrint(workspace[i]));
+}
+
+static void forwardIntScalar(const int* samples, int* coefficients) {
+    int workspace[64];
+    for (int i = 0; i < 64; ++i) workspace[i] = samples[i];
+    for (int col = 0; col < 8; ++col) islowForward<true>(workspace + col, 8);
+    for (int row = 0; row < 8; ++row) islowForward<false>(workspace + row * 8, 1);
+    for (int i = 0; i < 64; ++i) coefficients[i] = workspace[i];
+}
+
+static void inverseIntScalar(const int* coefficients, int* samples) {
+    int workspace[64];
+    for (int i = 0; i < 64; ++i) workspace[i] = coefficients[i];
+    for (int col = 0; col < 8; ++col) islowInverse<true>(workspace + col, 8);
+    for (int row = 0; row < 8; ++row) islowInverse<false>(workspace + row * 8, 1);
+    for (int i = 0; i < 64; ++i) samples[i] = workspace[i];
+}
+
+
+#ifdef DCT_AVX2
+/*
+AVX2 kernels:
+
+r[i] holds row i. The column pass runs across the 8 vectors with one column per lane, a
+transpose turns the columns into vectors for the row pass, and a second one restores the rows.
+The load and store loops are unrolled so the rows stay in registers.
+*/
+__attribute__((target("avx2")))
+static inline void transpose8x8(__m256* r) {
+    __m256 t0 = _mm256_unpacklo_ps(r[0], r[1]);
+    __m256 t1 = _mm256_unpackhi_ps(r[0], r[1]);
+    __m256 t2 = _mm256_unpacklo_ps(r[2], r[3]);
+    __m256 t3 = _mm256_unpackhi_ps(r[2], r[3]);
+    __m256 t4 = _mm256_unpacklo_ps(r[4], r[5]);
+    __m256 t5 = _mm256_unpackhi_ps(r[4], r[5]);
+    __m256 t6 = _mm256_unpacklo_ps(r[6], r[7]);
+    __m256 t7 = _mm256_unpackhi_ps(r[6], r[7]);
+
+    __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+
+    r[0] = _mm256_permute2f128_ps(s0, s4, 0x20);
+    r[1] = _mm256_permute2f128_ps(s1, s5, 0x20);
+    r[2] = _mm256_permute2f128_ps(s2, s6, 0x20);
+    r[3] = _mm256_permute2f128_ps(s3, s7, 0x20);
+    r[4] = _mm256_permute2f128_ps(s0, s4, 0x31);
+    r[5] = _mm256_permute2f128_ps(s1, s5, 0x31);
+    r[6] = _mm256_permute2f128_ps(s2, s6, 0x31);
+    r[7] = _mm256_permute2f128_ps(s3, s7, 0x31);
+}
+
+__attribute__((target("avx2")))
+static void forwardAvx2(const int* samples, float* coefficients) {
+    __m256 r[8];
+#pragma GCC unroll 8
+    for (int i = 0; i < 8; ++i) {
+        r[i] = _mm256_cvtepi32_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(samples + i * 8)));
+    }
+    aanForward(r, 1);
+    transpose8x8(r);
+    aanForward(r, 1);
+    transpose8x8(r);
+#pragma GCC unroll 8
+    for (int i = 0; i < 8; ++i) _mm256_storeu_ps(coefficients + i * 8, r[i]);
+}
+
+__attribute__((target("avx2")))
+static void inverseAvx2(const float* coefficients, int* samples) {
+    __m256 r[8];
+#pragma GCC unroll 8
+    for (int i = 0; i < 8; ++i) r[i] = _mm256_loadu_ps(coefficients + i * 8);
+    aanInverse(r, 1);
+    transpose8x8(r);
+    aanInverse(r, 1);
+    transpose8x8(r);
+    // Rounds to nearest even like lrint in the scalar kernel
+#pragma GCC unroll 8
+    for (int i = 0; i < 8; ++i) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(samples + i * 8), _mm256_cvtps_epi32(r[i]));
+    }
+}
+// Integer kernels, 8 lanes of 32 bits through the same transpose
+typedef int v8si __attribute__((vector_size(32)));
+
+__attribute__((target("avx2")))
+static inline void transpose8x8(v8si* r) {
+    __m256 f[8];
+#pragma GCC unroll 8
+    for (int i = 0; i < 8; ++i) f[i] = _mm256_castsi256_ps((__m256i)r[i]);
+    transpose8x8(f);
+#pragma GCC unroll 8
+    for (int i = 0; i < 8; ++i) r[i] = (v8si)_mm256_castps_si256(f[i]);
+}
+
+__attribute__((target("avx2")))
+static void forwardIntAvx2(const int* samples, int* coefficients) {
+    v8si r[8];
+#pragma GCC unroll 8
+    for (int i = 0; i < 8; ++i) r[i] = (v8si)_mm256_loadu_si256(reinterpret_cast<const __m256i*>(samples + i * 8));
+    islowForward<true>(r, 1);
+    transpose8x8(r);
+    islowForward<false>(r, 1);
+    transpose8x8(r);
+#pragma GCC unroll 8
+    for (int i = 0; i < 8; ++i) _mm256_storeu_si256(reinterpret_cast<__m256i*>(coefficients + i * 8), (__m256i)r[i]);
+}
+
+__attribute__((target("avx2")))
+static void inverseIntAvx2(const int* coefficients, int* samples) {
+    v8si r[8];
+#pragma GCC unroll 8
+    for (int i = 0; i < 8; ++i) r[i] = (v8si)_mm256_loadu_si256(reinterpret_cast<const __m256i*>(coefficients + i * 8));
+    islowInverse<true>(r, 1);
+    transpose8x8(r);
+    islowInverse<false>(r, 1);
+    transpose8x8(r);
+#pragma GCC unroll 8
+    for (int i = 0; i < 8; ++i) _mm256_storeu_si256(reinterpret_cast<__m256i*>(samples + i * 8), (__m256i)r[i]);
+}
+#endif
+
+
+#ifdef DCT_NEON
+/*
+NEON kernels:
+
+r[0][i] holds columns 0-3 of row i, r[1][i] columns 4-7. Each pass runs twice, once per half,
+and the 8x8 transpose is four 4x4 ones with the two off diagonal quarters swapped.
+*/
+static inline void transpose4x4(float32x4_t* a) {
+    float32x4x2_t p01 = vtrnq_f32(a[0], a[1]);
+    float32x4x2_t p23 = vtrnq_f32(a[2], a[3]);
+    a[0] = vcombine_f32(vget_low_f32(p01.val[0]), vget_low_f32(p23.val[0]));
+    a[1] = vcombine_f32(vget_low_f32(p01.val[1]), vget_low_f32(p23.val[1]));
+    a[2] = vcombine_f32(vget_high_f32(p01.val[0]), vget_high_f32(p23.val[0]));
+    a[3] = vcombine_f32(vget_high_f32(p01.val[1]), vget_high_f32(p23.val[1]));
+}
+
+static inline void transpose8x8(float32x4_t (*r)[8]) {
+    transpose4x4(r[0]);
+    transpose4x4(r[0] + 4);
+    transpose4x4(r[1]);
+    transpose4x4(r[1] + 4);
+    for (int i = 0; i < 4; ++i) {
+        float32x4_t quarter = r[1][i];
+        r[1][i] = r[0][i + 4];
+        r[0][i + 4] = quarter;
+    }
+}
+
+static void forwardNeon(const int* samples, float* coefficients) {
+    float32x4_t r[2][8];
+    for (int i = 0; i < 8; ++i) {
+        r[0][i] = vcvtq_f32_s32(vld1q_s32(samples + i * 8));
+        r[1][i] = vcvtq_f32_s32(vld1q_s32(samples + i * 8 + 4));
+    }
+    aanForward(r[0], 1);
+    aanForward(r[1], 1);
+    transpose8x8(r);
+    aanForward(r[0], 1);
+    aanForward(r[1], 1);
+    transpose8x8(r);
+    for (int i = 0; i < 8; ++i) {
+        vst1q_f32(coefficients + i * 8, r[0][i]);
+        vst1q_f32(coefficients + i * 8 + 4, r[1][i]);
+    }
+}
+
+static void inverseNeon(const float* coefficients, int* samples) {
+    float32x4_t r[2][8];
+    for (int i = 0; i < 8; ++i) {
+        r[0][i] = vld1q_f32(coefficients + i * 8);
+        r[1][i] = vld1q_f32(coefficients + i * 8 + 4);
+    }
+    aanInverse(r[0], 1);
+    aanInverse(r[1], 1);
+    transpose8x8(r);
+    aanInverse(r[0], 1);
+    aanInverse(r[1], 1);
+    transpose8x8(r);
+    for (int i = 0; i < 8; ++i) {
+        vst1q_s32(samples + i * 8, vcvtnq_s32_f32(r[0][i]));
+        vst1q_s32(samples + i * 8 + 4, vcvtnq_s32_f32(r[1][i]));
+    }
+}
+// Integer kernels, the 32-bit lanes go through the float transpose unchanged
+static inline void transpose8x8(int32x4_t (*r)[8]) {
+    float32x4_t f[2][8];
+    for (int h = 0; h < 2; ++h) {
+        for (int i = 0; i < 8; ++i) f[h][i] = vreinterpretq_f32_s32(r[h][i]);
+    }
+    transpose8x8(f);
+    for (int h = 0; h < 2; ++h) {
+        for (int i = 0; i < 8; ++i) r[h][i] = vreinterpretq_s32_f32(f[h][i]);
+    }
+}
+
+static void forwardIntNeon(const int* samples, int* coefficients) {
+    int32x4_t r[2][8];
+    for (int i = 0; i < 8; ++i) {
+        r[0][i] = vld1q_s32(samples + i * 8);
+        r[1][i] = vld1q_s32(samples + i * 8 + 4);
+    }
+    islowForward<true>(r[0], 1);
+    islowForward<true>(r[1], 1);
+    transpose8x8(r);
+    islowForward<false>(r[0], 1);
+    islowForward<false>(r[1], 1);
+    transpose8x8(r);
+    for (int i = 0; i < 8; ++i) {
+        vst1q_s32(coefficients + i * 8, r[0][i]);
+        vst1q_s32(coefficients + i * 8 + 4, r[1][i]);
+    }
+}
+
+static void inverseIntNeon(const int* coefficients, int* samples) {
+    int32x4_t r[2][8];
+    for (int i = 0; i < 8; ++i) {
+        r[0][i] = vld1q_s32(coefficients + i * 8);
+        r[1][i] = vld1q_s32(coefficients + i * 8 + 4);
+    }
+    islowInverse<true>(r[0], 1);
+    islowInverse<true>(r[1], 1);
+    transpose8x8(r);
+    islowInverse<false>(r[0], 1);
+    islowInverse<false>(r[1], 1);
+    transpose8x8(r);
+    for (int i = 0; i < 8; ++i) {
+        vst1q_s32(samples + i * 8, r[0][i]);
+        vst1q_s32(samples + i * 8 + 4, r[1][i]);
+    }
+}
+#endif
+
+
+/*
+Runtime dispatch:
+
+The kernels are chosen on the first call and kept for the life of the process.
+*/
+namespace {
+
+struct DctKernels {
+    const char* name;
+    void (*forward)(const int*, float*);
+    void (*inverse)(const float*, int*);
+    void (*forwardInt)(const int*, int*);
+    void (*inverseInt)(const int*, int*);
+};
+
+DctKernels detectKernels() {
+#if defined(DCT_AVX2)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return DctKernels{"avx2", forwardAvx2, inverseAvx2, forwardIntAvx2, inverseIntAvx2};
+#elif defined(DCT_NEON)
+    return DctKernels{"neon", forwardNeon, inverseNeon, forwardIntNeon, inverseIntNeon};
+#endif
+    return DctKernels{"scalar", forwardScalar, inverseScalar, forwardIntScalar, inverseIntScalar};
+}
+
+const DctKernels& kernels() {
+    static const DctKernels selected = detectKernels();
+    return selected;
+}
+
+} // namespace
+
+void forwardDCT(const int* samples, float* coefficients) {
+    kernels().forward(samples, coefficients);
+}
+
+void inverseDCT(const float* coefficients, int* samples) {
+    kernels().inverse(coefficients, samples);
+}
+
+void forwardDCTInt(const int* samples, int* coefficients) {
+    kernels().forwardInt(samples, coefficients);
+}
+
+void inverseDCTInt(const int* coefficients, int* samples) {
+    kernels().inverseInt(coefficients, samples);
+}
+
+const char* dctKernel() {
+    return kernels().name;
+}
+
+std::vector<float> quantDivisors(const std::vector<int>& quantTable) {
+    std::vector<float> divisors(64);
+    for (int row = 0; row < 8; ++row) {
+        for (int col = 0; col < 8; ++col) {
+            double scale = quantTable[row * 8 + col] * AAN_SCALE[row] * AAN_SCALE[col] * 8.0;
+            divisors[row * 8 + col] = static_cast<float>(1.0 / scale);
+        }
+    }
+    return divisors;
+}
+
+std::vector<float> dequantMultipliers(const std::vector<int>& quantTable) {
+    std::vector<float> multipliers(64);
+    for (int row = 0; row < 8; ++row) {
+        for (int col = 0; col < 8; ++col) {
+            double scale = quantTable[row * 8 + col] * AAN_SCALE[row] * AAN_SCALE[col] * 0.125;
+            multipliers[row * 8 + col] = static_cast<float>(scale);
+        }
+    }
+    return multipliers;
+}
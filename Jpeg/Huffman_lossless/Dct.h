@@ -0,0 +1,62 @@
+#ifndef DCT_H
+#define DCT_H
+
+#include <vector>
+
+/*
+8x8 DCT:
+
+Two separable transforms, picked with DctMethod.
+
+DCT_ISLOW, the default, is the fixed point Loeffler-Ligtenberg-Moschytz transform of libjpeg
+(jfdctint / jidctint): integer adds, multiplies and shifts only, so coefficients and decoded
+samples are bit-exact across platforms, compilers and kernels. Its forward output is 8 times
+the DCT, the quantization step is multiplied by 8 to match, and the inverse takes the plain
+dequantized values.
+
+DCT_FLOAT is the Arai-Agui-Nakajima transform (libjpeg's jfdctflt / jidctflt), 5 multiplies per
+1-D pass, so 80 per block. The AAN factorization leaves every coefficient scaled by
+8 * AAN_SCALE[row] * AAN_SCALE[col]; instead of undoing that per block, quantDivisors() and
+dequantMultipliers() fold it into the quantization step, which costs nothing. Its results can
+differ in the last bit between platforms (FMA contraction, libm rounding).
+
+Both run a 1-D pass over the 8 columns, then over the 8 rows. Blocks are row major in both
+domains: sample[y * 8 + x], coefficient[v * 8 + u] with v the vertical and u the horizontal
+frequency, the layout the quantization tables are written in.
+
+The kernels are picked once at runtime from the CPU features: AVX2 on x86 (one block row per
+vector, all 8 columns or rows of a pass side by side in the lanes, transposed in registers
+between the passes), NEON on ARM64 (the same with two 4 lane halves per row), and a scalar
+fallback otherwise. Float lanes and 32-bit integer lanes use the same scheme.
+*/
+
+enum DctMethod {
+    DCT_ISLOW,  // Fixed point, bit-exact everywhere
+    DCT_FLOAT   // AAN in float
+};
+
+// AAN_SCALE[0] = 1, AAN_SCALE[k] = sqrt(2) * cos(k * pi / 16)
+extern const double AAN_SCALE[8];
+
+// Float forward transform of 64 samples, coefficients come out scaled as described above
+void forwardDCT(const int* samples, float* coefficients);
+
+// Float inverse transform of 64 coefficients already multiplied by dequantMultipliers(), samples are rounded
+void inverseDCT(const float* coefficients, int* samples);
+
+// 1 / (quantTable[i] * 8 * AAN_SCALE[row] * AAN_SCALE[col]), multiply the forwardDCT output by it
+std::vector<float> quantDivisors(const std::vector<int>& quantTable);
+
+// quantTable[i] * AAN_SCALE[row] * AAN_SCALE[col] / 8, multiply the quantized values by it for inverseDCT
+std::vector<float> dequantMultipliers(const std::vector<int>& quantTable);
+
+// Fixed point forward transform, coefficients come out 8 times the DCT. May run in place.
+void forwardDCTInt(const int* samples, int* coefficients);
+
+// Fixed point inverse transform of dequantized coefficients, samples are rounded. May run in place.
+void inverseDCTInt(const int* coefficients, int* samples);
+
+// Name of the kernels in use: "avx2", "neon" or "scalar"
+const char* dctKernel();
+
+#endif // DCT_H
@@ -18,6 +18,13 @@ Decompression is implemented by reversing the compression steps:
 #include <map>
 #include <string>
 #include <fstream>
+#include <stdexcept>
+#include <algorithm>
+#include "CoefficientBuffer.h"
+#include "ColorConvert.h"
+#include "Dct.h"
+#include "Sampling.h"
+#include "Symbols.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "lib/stb_image.h"
@@ -69,120 +76,158 @@ Node* loadHuffmanTree(std::ifstream& file) {
 
 
 
-// Function to decode the Huffman encoded data
-std::vector<int> decodeHuffmanData( std::ifstream& file, Node* root,size_t totalCoefficients) {
-    std::vector<int> decodedData;
-    Node* currentNode = root;
+// Reads the encoded bits, most significant first out of native 64-bit words
+struct BitReader {
+    std::ifstream& file;
+    uint64_t buffer;
+    int bitsRemaining;
 
-    uint64_t buffer = 0;
-    int bitsRemaining = 0;
+    explicit BitReader(std::ifstream& file) : file(file), buffer(0), bitsRemaining(0) {}
 
-    while (decodedData.size() < totalCoefficients) {
+    int readBit() {
         if (bitsRemaining == 0) {
-            file.read(reinterpret_cast<char*>(&buffer), sizeof(buffer));
+            if (!file.read(reinterpret_cast<char*>(&buffer), sizeof(buffer))) {
+                throw std::runtime_error("Encoded data is truncated.");
+            }
             bitsRemaining = 64;
         }
-
-        int bit = (buffer >> (bitsRemaining - 1)) & 1;
         bitsRemaining--;
-
-        currentNode = (bit == 0) ? currentNode->left : currentNode->right;
-
-        if (!currentNode->left && !currentNode->right) { // Leaf node
-            decodedData.push_back(currentNode->value);
-            currentNode = root;
-        }
+        return (buffer >> bitsRemaining) & 1;
     }
-    return decodedData;
-}
 
+    int readBits(int count) {
+        int bits = 0;
+        while (count-- > 0) bits = (bits << 1) | readBit();
+        return bits;
+    }
+};
 
-// Function to dequantize the coefficients
-void dequantize(std::vector<int>& block, const std::vector<int>& quantTable) {
-    for (size_t i = 0; i < block.size(); ++i) {
-        block[i] = round(block[i] * static_cast<double>(quantTable[i]));
+// Function to walk the Huffman tree down to the next symbol
+int decodeSymbol(BitReader& reader, Node* root) {
+    Node* currentNode = root;
+    while (currentNode->left || currentNode->right) {
+        currentNode = (reader.readBit() == 0) ? currentNode->left : currentNode->right;
+        if (!currentNode) throw std::runtime_error("Invalid Huffman code.");
     }
+    return currentNode->value;
 }
 
-
-// Function to apply IDCT to an 8x8 block
-void applyIDCT(std::vector<int>& block) {
-    std::vector<double> temp(64);
-    for (int x = 0; x < 8; ++x) {
-        for (int y = 0; y < 8; ++y) {
-            double sum = 0;
-            for (int u = 0; u < 8; ++u) {
-                for (int v = 0; v < 8; ++v) {
-                    double cu = (u == 0) ? 1 / sqrt(2.0) : 1.0;
-                    double cv = (v == 0) ? 1 / sqrt(2.0) : 1.0;
-                    sum += cu * cv * block[u * 8 + v] *
-                           cos(((2 * x + 1) * u * M_PI) / 16.0) *
-                           cos(((2 * y + 1) * v * M_PI) / 16.0);
-                }
+// Function to decode the symbols of every block (see Symbols.h) straight into the coefficient buffer
+void decodeHuffmanData(std::ifstream& file, Node* dcRoot, Node* acRoot, CoefficientBuffer& coefficients) {
+    BitReader reader(file);
+
+    for (size_t plane = 0; plane < coefficients.planeCount(); ++plane) {
+        BlockView blocks = coefficients.plane(plane);
+        int previousDC = 0;
+        for (size_t b = 0; b < blocks.size(); ++b) {
+            int16_t* block = blocks[b];
+
+            int size = decodeSymbol(reader, dcRoot);
+            previousDC += extendMagnitude(reader.readBits(size), size);
+            block[0] = static_cast<int16_t>(previousDC);
+
+            for (size_t k = 1; k < BLOCK_VALUES; ++k) {
+                int symbol = decodeSymbol(reader, acRoot);
+                if (symbol == EOB) break;
+                k += symbol >> 4; // Zeros before the coefficient, already 0 in the buffer
+                size = symbol & 15;
+                if (k >= BLOCK_VALUES) throw std::runtime_error("Run past the end of a block.");
+                if (symbol != ZRL) block[ZIGZAG[k]] = static_cast<int16_t>(extendMagnitude(reader.readBits(size), size));
             }
-            temp[y * 8 + x] = 0.25 * sum;
         }
     }
-
-    for (int i = 0; i < 64; ++i) {
-        block[i] = std::round(temp[i]);
-    }
 }
 
-std::vector<uint8_t> reconstructImage(const std::vector<std::vector<int>>& yBlocks, 
-                                      const std::vector<std::vector<int>>& cbBlocks, 
-                                      const std::vector<std::vector<int>>& crBlocks, 
-                                      int width, int height) {
-    std::vector<uint8_t> reconstructed(width * height * 3); // RGB data
 
-    int blockIndex = 0;
-    for (int yBlock = 0; yBlock < height; yBlock += 8) {
-        for (int xBlock = 0; xBlock < width; xBlock += 8) {
-            if (blockIndex >= yBlocks.size() || blockIndex / 4 >= cbBlocks.size() || blockIndex / 4 >= crBlocks.size()) {
-                std::cerr << "Block index out of bounds: " << blockIndex << std::endl;
-                std::cerr << "yBlocks size: " << yBlocks.size() << ", cbBlocks size: " << cbBlocks.size()
-                          << ", crBlocks size: " << crBlocks.size() << std::endl;
-
-            }
-
-            const auto& yBlockData = yBlocks[blockIndex];
-            const auto& cbBlockData = cbBlocks[blockIndex / 4]; // 4:2:0 subsampling
-            const auto& crBlockData = crBlocks[blockIndex / 4];
+// Function to dequantize the coefficients for the fixed point IDCT
+void dequantize(const int16_t* block, const std::vector<int>& quantTable, int* coefficients) {
+    for (size_t i = 0; i < BLOCK_VALUES; ++i) {
+        coefficients[i] = block[i] * quantTable[i];
+    }
+}
 
-            for (int dy = 0; dy < 8; ++dy) {
-                for (int dx = 0; dx < 8; ++dx) {
-                    int x = xBlock + dx;
-                    int y = yBlock + dy;
+// Function to dequantize the coefficients for the float IDCT, the multipliers also carry the scale inverseDCT expects
+void dequantize(const int16_t* block, const std::vector<float>& multipliers, float* coefficients) {
+    for (size_t i = 0; i < BLOCK_VALUES; ++i) {
+        coefficients[i] = block[i] * multipliers[i];
+    }
+}
 
-                    if (x < width && y < height) {
-                        int pixelIndex = (y * width + x) * 3;
 
-                        if ((dy / 2) * 4 + (dx / 2) >= cbBlockData.size() || (dy / 2) * 4 + (dx / 2) >= crBlockData.size()) {
-                            std::cerr << "Subsampling index out of bounds for block index: " << blockIndex << std::endl;
-                            continue; // Skip this pixel
-                        }
+// Function to apply IDCT to an 8x8 block, coefficients are row major with v the vertical frequency (see Dct.h)
+void applyIDCT(int* block) {
+    inverseDCTInt(block, block);
+}
 
-                        int Y = yBlockData[dy * 8 + dx];
-                        int Cb = cbBlockData[(dy / 2) * 4 + (dx / 2)]; // Subsampled
-                        int Cr = crBlockData[(dy / 2) * 4 + (dx / 2)]; // Subsampled
+void applyIDCT(const float* coefficients, int* block) {
+    inverseDCT(coefficients, block);
+}
 
-                        // Convert YCbCr to RGB
-                        // https://web.archive.org/web/20180421030430/http://www.equasys.de/colorconversion.html
 
-                        int R = clamp(Y + 1.400 * (Cr - 128), 0.0, 255.0);
-                        int G = clamp(Y - 0.343 * (Cb - 128) - 0.711 * (Cr - 128), 0.0, 255.0);
-                        int B = clamp(Y + 1.765 * (Cb - 128), 0.0, 255.0);
+// Function to dequantize and inverse transform every block of a plane into its samples, the padding is dropped
+std::vector<uint8_t> reconstructPlane(ConstBlockView blocks, const PlaneLayout& plane,
+                                      const std::vector<int>& quantTable, DctMethod method) {
+    std::vector<uint8_t> samples(static_cast<size_t>(plane.width) * plane.height);
+    std::vector<float> multipliers = dequantMultipliers(quantTable);
+    alignas(32) int block[BLOCK_VALUES];
+    alignas(32) float coefficients[BLOCK_VALUES];
+
+    for (int by = 0; by < plane.blocksY; ++by) {
+        for (int bx = 0; bx < plane.blocksX; ++bx) {
+            const int16_t* quantized = blocks[static_cast<size_t>(by) * plane.blocksX + bx];
+            if (method == DCT_FLOAT) {
+                dequantize(quantized, multipliers, coefficients);
+                applyIDCT(coefficients, block);
+            } else {
+                dequantize(quantized, quantTable, block);
+                applyIDCT(block);
+            }
 
-                        reconstructed[pixelIndex] = static_cast<uint8_t>(R);
-                        reconstructed[pixelIndex + 1] = static_cast<uint8_t>(G);
-                        reconstructed[pixelIndex + 2] = static_cast<uint8_t>(B);
-                    }
+            int rows = std::min(BLOCK_SIZE, plane.height - by * BLOCK_SIZE);
+            int cols = std::min(BLOCK_SIZE, plane.width - bx * BLOCK_SIZE);
+            for (int dy = 0; dy < rows; ++dy) {
+                uint8_t* row = samples.data() + static_cast<size_t>(by * BLOCK_SIZE + dy) * plane.width + bx * BLOCK_SIZE;
+                for (int dx = 0; dx < cols; ++dx) {
+                    row[dx] = static_cast<uint8_t>(clamp(block[dy * BLOCK_SIZE + dx], 0, 255));
                 }
             }
-            
-            ++blockIndex;
         }
     }
+    return samples;
+}
+
+// Function to upsample the chrominance and convert back to RGB, a row at a time with the kernels of Sampling.h and
+// ColorConvert.h
+std::vector<uint8_t> reconstructImage(const std::vector<uint8_t>& yPlane,
+                                      const std::vector<uint8_t>& cbPlane,
+                                      const std::vector<uint8_t>& crPlane,
+                                      int width, int height, Subsampling subsampling) {
+    std::vector<uint8_t> reconstructed(static_cast<size_t>(width) * height * 3); // RGB data
+    int h = horizontalFactor(subsampling);
+    int v = verticalFactor(subsampling);
+    int chromaWidth = (width + h - 1) / h;
+    int chromaHeight = (height + v - 1) / v;
+    std::vector<uint8_t> cbRow(chromaWidth * h), crRow(chromaWidth * h);
+
+    for (int y = 0; y < height; ++y) {
+        // The chroma row the image row falls in, and for 4:2:0 the one above or below it to blend in
+        int nearRow = y / v;
+        int farRow = nearRow;
+        if (v == 2) farRow = std::min(std::max(y % 2 == 0 ? nearRow - 1 : nearRow + 1, 0), chromaHeight - 1);
+        const uint8_t* cbNear = cbPlane.data() + static_cast<size_t>(nearRow) * chromaWidth;
+        const uint8_t* crNear = crPlane.data() + static_cast<size_t>(nearRow) * chromaWidth;
+        const uint8_t* cb = cbNear;
+        const uint8_t* cr = crNear;
+        if (h == 2) {
+            upsampleRow(cbNear, cbPlane.data() + static_cast<size_t>(farRow) * chromaWidth, cbRow.data(), chromaWidth);
+            upsampleRow(crNear, crPlane.data() + static_cast<size_t>(farRow) * chromaWidth, crRow.data(), chromaWidth);
+            cb = cbRow.data();
+            cr = crRow.data();
+        }
+
+        yCbCrToRgbRow(yPlane.data() + static_cast<size_t>(y) * width, cb, cr,
+                      reconstructed.data() + static_cast<size_t>(y) * width * 3, width);
+    }
 
     return reconstructed;
 }
@@ -196,64 +241,58 @@ void saveImage(const std::string& outputPath, const std::vector<uint8_t>& imageD
 }
 
 
-// Main decompression function
-void decompressJPEG(const std::string& inputFile, const std::string& outputFile) {
+// Main decompression function, the fixed point IDCT gives the same pixels on every platform
+void decompressJPEG(const std::string& inputFile, const std::string& outputFile, DctMethod method = DCT_ISLOW) {
     std::ifstream file(inputFile, std::ios::binary);
     if (!file) throw std::runtime_error("Failed to open input file.");
 
 
-    // Input the image size in pixels
-    int width = 200;
-    int height = 200;
+    // Step 0: Read the image size and the chroma subsampling, the plane layout follows from them
+    int width = 0;
+    int height = 0;
+    file.read(reinterpret_cast<char*>(&width), sizeof(width));
+    file.read(reinterpret_cast<char*>(&height), sizeof(height));
+    if (!file || width <= 0 || height <= 0) throw std::runtime_error("Invalid image size.");
+
+    char mode = 0;
+    if (!file.get(mode) || mode < SUBSAMPLING_420 || mode > SUBSAMPLING_444) {
+        throw std::runtime_error("Invalid chroma subsampling.");
+    }
+    Subsampling subsampling = static_cast<Subsampling>(mode);
+
+    // The luminance and chrominance quantization tables the encoder used, one byte per step
+    std::vector<std::vector<int>> quantTables(2, std::vector<int>(BLOCK_VALUES));
+    for (std::vector<int>& table : quantTables) {
+        for (int& step : table) {
+            char value = 0;
+            file.get(value);
+            step = static_cast<uint8_t>(value);
+            if (!file || step == 0) throw std::runtime_error("Invalid quantization table.");
+        }
+    }
+
+    int chromaWidth = (width + horizontalFactor(subsampling) - 1) / horizontalFactor(subsampling);
+    int chromaHeight = (height + verticalFactor(subsampling) - 1) / verticalFactor(subsampling);
+    CoefficientBuffer coefficients;
+    coefficients.reset({{width, height}, {chromaWidth, chromaHeight}, {chromaWidth, chromaHeight}});
 
-    // Step 1: Load Huffman tree
-    Node* huffmanTree = loadHuffmanTree(file);
-    if (!huffmanTree) throw std::runtime_error("Failed to load Huffman tree.");
+    // Step 1: Load the DC and AC Huffman trees
+    Node* dcTree = loadHuffmanTree(file);
+    Node* acTree = loadHuffmanTree(file);
+    if (!dcTree || !acTree) throw std::runtime_error("Failed to load Huffman tree.");
 
     // Step 2: Decode Huffman data
-    int expected_size = 59968;
-    auto coefficients = decodeHuffmanData(file, huffmanTree, expected_size);
+    decodeHuffmanData(file, dcTree, acTree, coefficients);
 
     // Step 3: Dequantize and apply IDCT
-    std::vector<int> quantTable = { 16,11,12,14,12,10,16,14,
-                13,14,18,17,16,19,24,40,
-                26,24,22,22,24,49,35,37,
-                29,40,58,51,61,60,57,51,
-                56,55,64,72,92,78,64,68,
-                87,69,55,56,80,109,81,87,
-                95,98,103,104,103,62,77,113,
-                121,112,100,120,92,101,103,99 };
-
-    std::vector<std::vector<int>> yBlocks, cbBlocks, crBlocks;
-
-    // Total number of blocks
-    size_t totalBlocks = coefficients.size() / 64;
-
-    // Calculate the number of blocks for each channel
-    size_t yBlockCount = (width * height) / 64;
-    size_t cbCrBlockCount = (totalBlocks-yBlockCount)/2;
-
-    // Split coefficients into blocks and assign to Y, Cb, and Cr channels
-    for (size_t i = 0; i < totalBlocks; ++i) {
-        std::vector<int> block(coefficients.begin() + i * 64, coefficients.begin() + (i + 1) * 64);
-        dequantize(block, quantTable);
-        applyIDCT(block);
-
-        if (i < yBlockCount) {
-            yBlocks.push_back(block); // Assign to Y channel
-        } else if (i < yBlockCount + cbCrBlockCount) {
-            cbBlocks.push_back(block); // Assign to Cb channel
-        } else {
-            crBlocks.push_back(block); // Assign to Cr channel
-        }
+    std::vector<uint8_t> planes[3];
+    for (size_t plane = 0; plane < coefficients.planeCount(); ++plane) {
+        const std::vector<int>& quantTable = quantTables[plane == 0 ? 0 : 1];
+        planes[plane] = reconstructPlane(coefficients.plane(plane), coefficients.layout(plane), quantTable, method);
     }
-    // Adding an additional block same as the last block to manage extreme end pixels
-    yBlocks.push_back(yBlocks[yBlockCount-1]);
-    cbBlocks.push_back(cbBlocks[cbCrBlockCount-1]);
-    crBlocks.push_back(crBlocks[cbCrBlockCount-1]);
 
     // Step 4: Reconstruct the image
-    auto reconstructedImage = reconstructImage(yBlocks, cbBlocks, crBlocks, width, height);
+    auto reconstructedImage = reconstructImage(planes[0], planes[1], planes[2], width, height, subsampling);
 
     // Step 5: Save the decompressed image
     saveImage(outputFile, reconstructedImage, width, height);
@@ -0,0 +1,210 @@
+#include <algorithm>
+#include "Sampling.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <immintrin.h>
+#define SAMPLING_X86
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define SAMPLING_NEON
+#endif
+
+int horizontalFactor(Subsampling subsampling) {
+    return subsampling == SUBSAMPLING_444 ? 1 : 2;
+}
+
+int verticalFactor(Subsampling subsampling) {
+    return subsampling == SUBSAMPLING_420 ? 2 : 1;
+}
+
+
+/*
+Scalar kernels:
+
+The upsampler works on column sums, 3 * near + far, which carry the vertical 3/4 and 1/4 weights
+(times 4). Each pair of outputs then weighs its column sum 3 to 1 with the left or right
+neighbour, so the total weight is 16; the two outputs round with +8 and +7, as in libjpeg, to
+keep the rounding of a pair unbiased. The vector kernels only do the interior of a row and
+leave the edges, and the tail they cannot fill, to these.
+*/
+static void downsampleScalar(const uint8_t* top, const uint8_t* bottom, uint8_t* out, int begin, int end) {
+    for (int i = begin; i < end; ++i) {
+        out[i] = static_cast<uint8_t>((top[2 * i] + top[2 * i + 1] + bottom[2 * i] + bottom[2 * i + 1] + 2) >> 2);
+    }
+}
+
+static inline int columnSum(const uint8_t* near, const uint8_t* far, int i) {
+    return 3 * near[i] + far[i];
+}
+
+static void upsampleScalar(const uint8_t* near, const uint8_t* far, uint8_t* out, int count, int begin, int end) {
+    for (int i = begin; i < end; ++i) {
+        int center = 3 * columnSum(near, far, i);
+        int left = columnSum(near, far, std::max(i - 1, 0));
+        int right = columnSum(near, far, std::min(i + 1, count - 1));
+        out[2 * i] = static_cast<uint8_t>((center + left + 8) >> 4);
+        out[2 * i + 1] = static_cast<uint8_t>((center + right + 7) >> 4);
+    }
+}
+
+static void downsampleRowScalar(const uint8_t* top, const uint8_t* bottom, uint8_t* out, int count) {
+    downsampleScalar(top, bottom, out, 0, count);
+}
+
+static void upsampleRowScalar(const uint8_t* near, const uint8_t* far, uint8_t* out, int count) {
+    upsampleScalar(near, far, out, count, 0, count);
+}
+
+
+#ifdef SAMPLING_X86
+/*
+SSE4.1 kernels:
+
+The downsampler adds horizontal pairs with maddubs against a vector of ones, 32 samples of each
+row into 16 sums, and packs the rounded averages back to bytes. The upsampler computes the
+column sums in 16-bit lanes at the sample and at its two neighbours (three unaligned loads), and
+interleaves the even and odd outputs with unpacks before packing.
+*/
+__attribute__((target("sse4.1")))
+static void downsampleRowSse41(const uint8_t* top, const uint8_t* bottom, uint8_t* out, int count) {
+    __m128i ones = _mm_set1_epi8(1);
+    __m128i two = _mm_set1_epi16(2);
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i sums[2];
+        for (int k = 0; k < 2; ++k) {
+            __m128i t = _mm_loadu_si128(reinterpret_cast<const __m128i*>(top + 2 * i + k * 16));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom + 2 * i + k * 16));
+            __m128i sum = _mm_add_epi16(_mm_maddubs_epi16(t, ones), _mm_maddubs_epi16(b, ones));
+            sums[k] = _mm_srli_epi16(_mm_add_epi16(sum, two), 2);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(sums[0], sums[1]));
+    }
+    downsampleScalar(top, bottom, out, i, count);
+}
+
+// 3 * near + far for the 16 samples at p, low and high 8 in 16-bit lanes
+__attribute__((target("sse4.1")))
+static inline void columnSums(const uint8_t* near, const uint8_t* far, __m128i* sums) {
+    __m128i zero = _mm_setzero_si128();
+    __m128i n = _mm_loadu_si128(reinterpret_cast<const __m128i*>(near));
+    __m128i f = _mm_loadu_si128(reinterpret_cast<const __m128i*>(far));
+    __m128i halves[2][2] = {{_mm_unpacklo_epi8(n, zero), _mm_unpackhi_epi8(n, zero)},
+                            {_mm_unpacklo_epi8(f, zero), _mm_unpackhi_epi8(f, zero)}};
+    for (int k = 0; k < 2; ++k) {
+        sums[k] = _mm_add_epi16(_mm_add_epi16(halves[0][k], _mm_slli_epi16(halves[0][k], 1)), halves[1][k]);
+    }
+}
+
+__attribute__((target("sse4.1")))
+static void upsampleRowSse41(const uint8_t* near, const uint8_t* far, uint8_t* out, int count) {
+    __m128i seven = _mm_set1_epi16(7);
+    __m128i eight = _mm_set1_epi16(8);
+    int end = 1;
+    // The loads reach one sample left and right, so the first sample and the last 16 are scalar
+    for (int i = 1; i + 17 <= count; i += 16) {
+        __m128i left[2], center[2], right[2];
+        columnSums(near + i - 1, far + i - 1, left);
+        columnSums(near + i, far + i, center);
+        columnSums(near + i + 1, far + i + 1, right);
+        for (int k = 0; k < 2; ++k) {
+            __m128i weighted = _mm_add_epi16(center[k], _mm_slli_epi16(center[k], 1));
+            __m128i even = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(weighted, left[k]), eight), 4);
+            __m128i odd = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(weighted, right[k]), seven), 4);
+            __m128i pairs = _mm_packus_epi16(_mm_unpacklo_epi16(even, odd), _mm_unpackhi_epi16(even, odd));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i + k * 16), pairs);
+        }
+        end = i + 16;
+    }
+    upsampleScalar(near, far, out, count, 0, 1);
+    upsampleScalar(near, far, out, count, end, count);
+}
+#endif
+
+
+#ifdef SAMPLING_NEON
+/*
+NEON kernels:
+
+vpaddl / vpadal add the horizontal pairs of both rows into 16-bit lanes and vrshrn rounds and
+narrows the average. The upsampler builds the column sums with a widening multiply-add and
+vst2 interleaves the even and odd outputs on the store.
+*/
+static void downsampleRowNeon(const uint8_t* top, const uint8_t* bottom, uint8_t* out, int count) {
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint8x8_t averages[2];
+        for (int k = 0; k < 2; ++k) {
+            uint16x8_t sum = vpaddlq_u8(vld1q_u8(top + 2 * i + k * 16));
+            sum = vpadalq_u8(sum, vld1q_u8(bottom + 2 * i + k * 16));
+            averages[k] = vrshrn_n_u16(sum, 2);
+        }
+        vst1q_u8(out + i, vcombine_u8(averages[0], averages[1]));
+    }
+    downsampleScalar(top, bottom, out, i, count);
+}
+
+static inline uint16x8_t columnSums(const uint8_t* near, const uint8_t* far) {
+    return vmlal_u8(vmovl_u8(vld1_u8(far)), vld1_u8(near), vdup_n_u8(3));
+}
+
+static void upsampleRowNeon(const uint8_t* near, const uint8_t* far, uint8_t* out, int count) {
+    int end = 1;
+    // The loads reach one sample left and right, so the first sample and the last 8 are scalar
+    for (int i = 1; i + 9 <= count; i += 8) {
+        uint16x8_t left = columnSums(near + i - 1, far + i - 1);
+        uint16x8_t center = columnSums(near + i, far + i);
+        uint16x8_t right = columnSums(near + i + 1, far + i + 1);
+        uint8x8x2_t pairs;
+        pairs.val[0] = vrshrn_n_u16(vmlaq_n_u16(left, center, 3), 4);
+        pairs.val[1] = vshrn_n_u16(vaddq_u16(vmlaq_n_u16(right, center, 3), vdupq_n_u16(7)), 4);
+        vst2_u8(out + 2 * i, pairs);
+        end = i + 8;
+    }
+    upsampleScalar(near, far, out, count, 0, 1);
+    upsampleScalar(near, far, out, count, end, count);
+}
+#endif
+
+
+/*
+Runtime dispatch:
+
+The kernels are chosen on the first call and kept for the life of the process.
+*/
+namespace {
+
+struct SamplingKernels {
+    const char* name;
+    void (*downsample)(const uint8_t*, const uint8_t*, uint8_t*, int);
+    void (*upsample)(const uint8_t*, const uint8_t*, uint8_t*, int);
+};
+
+SamplingKernels detectKernels() {
+#if defined(SAMPLING_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.1")) return SamplingKernels{"sse4.1", downsampleRowSse41, upsampleRowSse41};
+#elif defined(SAMPLING_NEON)
+    return SamplingKernels{"neon", downsampleRowNeon, upsampleRowNeon};
+#endif
+    return SamplingKernels{"scalar", downsampleRowScalar, upsampleRowScalar};
+}
+
+const SamplingKernels& kernels() {
+    static const SamplingKernels selected = detectKernels();
+    return selected;
+}
+
+} // namespace
+
+void downsampleRow(const uint8_t* top, const uint8_t* bottom, uint8_t* out, int count) {
+    kernels().downsample(top, bottom, out, count);
+}
+
+void upsampleRow(const uint8_t* near, const uint8_t* far, uint8_t* out, int count) {
+    kernels().upsample(near, far, out, count);
+}
+
+const char* samplingKernel() {
+    return kernels().name;
+}
@@ -0,0 +1,42 @@
+#ifndef SAMPLING_H
+#define SAMPLING_H
+
+#include <cstdint>
+
+/*
+Chroma subsampling:
+
+Cb and Cr are stored at a lower resolution than Y. 4:2:0 halves them in both directions, 4:2:2
+only horizontally, 4:4:4 keeps them whole; odd sizes round up.
+
+The encoder averages each 2x2 (or 2x1) group of samples, which puts the chroma sample at the
+center of its group and filters out detail that would alias. The decoder interpolates back
+with libjpeg's "fancy" triangle filter: every output sample is 3/4 of the nearest input sample
+and 1/4 of the next one, in each direction. Edges repeat the last sample.
+
+The kernels run along rows with pairwise adds and 16-bit lanes (SSE4.1 on x86, NEON on ARM64),
+or as a scalar loop, picked once at runtime.
+*/
+
+enum Subsampling {
+    SUBSAMPLING_420,  // Half width, half height
+    SUBSAMPLING_422,  // Half width
+    SUBSAMPLING_444   // Full resolution
+};
+
+// Luma samples per chroma sample across and down
+int horizontalFactor(Subsampling subsampling);
+int verticalFactor(Subsampling subsampling);
+
+// out[i] = average of top[2i], top[2i + 1], bottom[2i] and bottom[2i + 1], rounded. The rows hold
+// 2 * count samples; passing the same row twice averages horizontal pairs only.
+void downsampleRow(const uint8_t* top, const uint8_t* bottom, uint8_t* out, int count);
+
+// Writes 2 * count samples interpolated from the count samples of near, the chroma row closest to
+// the output row, and far, the one on its other side (near again for no vertical filtering).
+void upsampleRow(const uint8_t* near, const uint8_t* far, uint8_t* out, int count);
+
+// Name of the kernels in use: "sse4.1", "neon" or "scalar"
+const char* samplingKernel();
+
+#endif // SAMPLING_H
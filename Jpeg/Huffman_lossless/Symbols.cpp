@@ -0,0 +1,31 @@
+#include "Symbols.h"
+
+const int ZIGZAG[64] = {
+     0,  1,  8, 16,  9,  2,  3, 10,
+    17, 24, 32, 25, 18, 11,  4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34,
+    27, 20, 13,  6,  7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36,
+    29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46,
+    53, 60, 61, 54, 47, 55, 62, 63
+};
+
+int magnitudeCategory(int value) {
+    unsigned magnitude = static_cast<unsigned>(value < 0 ? -value : value);
+    int size = 0;
+    while (magnitude) {
+        ++size;
+        magnitude >>= 1;
+    }
+    return size;
+}
+
+int magnitudeBits(int value, int size) {
+    return (value < 0 ? value - 1 : value) & ((1 << size) - 1);
+}
+
+int extendMagnitude(int bits, int size) {
+    if (size == 0) return 0;
+    return bits < (1 << (size - 1)) ? bits - (1 << size) + 1 : bits;
+}
@@ -0,0 +1,37 @@
+#ifndef SYMBOLS_H
+#define SYMBOLS_H
+
+/*
+Entropy coding symbols:
+
+The symbol model of baseline JPEG. A block is read in zigzag order, low frequencies first, so
+the zeros the quantizer leaves at the high frequencies end up in one run at the end.
+
+The DC coefficient is coded as its difference to the DC of the previous block of the same
+plane, its symbol is the size of that difference (see magnitudeCategory).
+
+Each nonzero AC coefficient gets the symbol (run << 4) | size, with run the number of zeros
+before it in zigzag order, 0 to 15. ZRL stands for 16 zeros when a run is longer, EOB for
+"only zeros remain in the block".
+
+Every symbol with a nonzero size is followed by size raw bits that give the value within its
+size category (see magnitudeBits).
+*/
+
+// Natural (row major) index of the k-th coefficient in zigzag order
+extern const int ZIGZAG[64];
+
+const int EOB = 0x00;
+const int ZRL = 0xF0;
+const int MAX_RUN = 15;
+
+// Number of bits of |value|, 0 for 0: values of size s lie in +-[2^(s-1), 2^s - 1]
+int magnitudeCategory(int value);
+
+// The size low bits written after a symbol, negative values are stored as value - 1
+int magnitudeBits(int value, int size);
+
+// Value of the size bits read after a symbol, the inverse of magnitudeBits
+int extendMagnitude(int bits, int size);
+
+#endif // SYMBOLS_H
@@ -0,0 +1,121 @@
+// ThreadPool.cpp
+#include "ThreadPool.h"
+
+/*
+How does it work:
+Each worker loops: pop the back of its own deque, else steal the front of the others, else
+sleep until a submission wakes it. "queued" counts the tasks in all deques so a worker only
+sleeps when there is really nothing to take, and "pending" counts tasks until they finish so
+wait() returns only once the last one is done. A task that throws still counts as finished; the
+first exception is kept and rethrown by wait().
+*/
+
+// Index of the pool worker running on this thread, -1 elsewhere
+static thread_local int currentWorker = -1;
+static thread_local const ThreadPool* currentPool = nullptr;
+
+ThreadPool::ThreadPool(unsigned threads)
+    : pending(0)
+    , nextQueue(0)
+    , queued(0)
+    , stopping(false)
+{
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+    for (unsigned i = 0; i < threads; ++i) queues.emplace_back(new Queue());
+    for (unsigned i = 0; i < threads; ++i) workers.emplace_back(&ThreadPool::run, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(stateLock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) worker.join();
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    unsigned index = currentPool == this ? static_cast<unsigned>(currentWorker)
+                                         : nextQueue++ % static_cast<unsigned>(queues.size());
+    // Pending before it is queued, so it cannot finish before it is counted. Queued after the
+    // push but before the deque is unlocked, so a worker that sees it finds the task, and no
+    // worker can take the task before it is counted.
+    ++pending;
+    {
+        std::lock_guard<std::mutex> guard(queues[index]->lock);
+        queues[index]->tasks.push_back(std::move(task));
+        std::lock_guard<std::mutex> state(stateLock);
+        ++queued;
+    }
+    wake.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> guard(stateLock);
+    finished.wait(guard, [this]() { return pending == 0; });
+    if (error) {
+        std::exception_ptr thrown = error;
+        error = nullptr;
+        std::rethrow_exception(thrown);
+    }
+}
+
+bool ThreadPool::take(unsigned index, std::function<void()>& task) {
+    // Step 1: Own deque, newest first
+    {
+        Queue& own = *queues[index];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+
+    // Step 2: Steal the oldest task of another worker
+    for (size_t k = 1; k < queues.size(); ++k) {
+        Queue& other = *queues[(index + k) % queues.size()];
+        std::lock_guard<std::mutex> guard(other.lock);
+        if (!other.tasks.empty()) {
+            task = std::move(other.tasks.front());
+            other.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::run(unsigned index) {
+    currentWorker = static_cast<int>(index);
+    currentPool = this;
+
+    std::function<void()> task;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> guard(stateLock);
+            wake.wait(guard, [this]() { return stopping || queued > 0; });
+            if (queued == 0) return;
+        }
+
+        if (!take(index, task)) continue;
+        {
+            std::lock_guard<std::mutex> guard(stateLock);
+            --queued;
+        }
+
+        // An exception must not skip the pending count, wait() would never return
+        try {
+            task();
+        } catch (...) {
+            std::lock_guard<std::mutex> guard(stateLock);
+            if (!error) error = std::current_exception();
+        }
+        task = nullptr;
+
+        if (--pending == 0) {
+            std::lock_guard<std::mutex> guard(stateLock);
+            finished.notify_all();
+        }
+    }
+}
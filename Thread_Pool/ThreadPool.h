@@ -0,0 +1,60 @@
+// ThreadPool.h
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+Work stealing thread pool. Every worker owns a deque of tasks: it takes its own work from the
+back (the task it queued last, whose data is still in cache) and, once that runs dry, steals
+from the front of the other deques (the oldest, usually largest, pieces of work). Tasks
+submitted by a worker go to its own deque, tasks from other threads are dealt round robin.
+*/
+
+class ThreadPool {
+public:
+    // threads 0 uses every core
+    explicit ThreadPool(unsigned threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> task);
+
+    // Block until every task submitted so far has finished, then rethrow the first exception a
+    // task threw since the last wait(), if any. Not for use inside a task.
+    void wait();
+
+    unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+private:
+    struct Queue {
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> pending;       // Submitted and not finished yet
+    std::atomic<unsigned> nextQueue;   // Round robin for submissions from outside the pool
+    std::mutex stateLock;
+    std::condition_variable wake;      // New work or shutdown
+    std::condition_variable finished;  // pending dropped to 0
+    size_t queued;                     // Tasks sitting in the deques, guarded by stateLock
+    std::exception_ptr error;          // First exception thrown by a task, guarded by stateLock
+    bool stopping;
+
+    void run(unsigned index);
+    bool take(unsigned index, std::function<void()>& task);
+};
+
+#endif // THREADPOOL_H
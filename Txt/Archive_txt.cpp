@@ -0,0 +1,520 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include "Archive_txt.h"
+#include "Dedup_txt.h"
+#include "Extract_txt.h"
+#include "Levels_txt.h"
+#include "../Thread_Pool/ThreadPool.h"
+
+using namespace std;
+
+
+// u8 type, u32 mode, u64 size, u32 path length
+static const size_t FILE_ENTRY_SIZE = 17;
+// Blocks handed to the pool at once, per worker. The next batch is read while one compresses.
+static const size_t ARCHIVE_BATCH_PER_THREAD = 4;
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+File table :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+string encodeFileTable(const vector<ArchiveEntry>& entries) {
+    string out;
+    putU32(out, static_cast<uint32_t>(entries.size()));
+    for (const ArchiveEntry& entry : entries) {
+        out.push_back(static_cast<char>(entry.type));
+        putU32(out, entry.mode);
+        putU64(out, entry.size);
+        putU32(out, static_cast<uint32_t>(entry.path.size()));
+        out += entry.path;
+    }
+    return out;
+}
+
+bool decodeFileTable(const string& data, uint64_t originalSize, vector<ArchiveEntry>& entries) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(data.data());
+    size_t size = data.size(), pos = 4;
+    if (size < 4) return false;
+    uint32_t count = getU32(p);
+
+    entries.clear();
+    uint64_t offset = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        if (size - pos < FILE_ENTRY_SIZE || p[pos] > static_cast<uint8_t>(ArchiveEntryType::Directory)) return false;
+        ArchiveEntry entry;
+        entry.type = static_cast<ArchiveEntryType>(p[pos]);
+        entry.mode = getU32(p + pos + 1);
+        entry.size = getU64(p + pos + 5);
+        uint32_t length = getU32(p + pos + 13);
+        pos += FILE_ENTRY_SIZE;
+        if (size - pos < length) return false;
+        entry.path.assign(data, pos, length);
+        pos += length;
+
+        // The data of the files covers the original data exactly
+        if (entry.type == ArchiveEntryType::Directory && entry.size != 0) return false;
+        if (entry.size > originalSize - offset) return false;
+        entry.offset = offset;
+        offset += entry.size;
+        entries.push_back(entry);
+    }
+    return pos == size && offset == originalSize;
+}
+
+// Tables of many small files are mostly repeated path prefixes and zero bytes, so the section
+// is compressed like a data block
+static string packFileTable(const LevelParams& params, const string& table) {
+    BlockHeader header;
+    string payload, section;
+    compressBlock(params, reinterpret_cast<const uint8_t*>(table.data()), table.size(), header, payload);
+    section.push_back(static_cast<char>(header.codec));
+    section.push_back(static_cast<char>(header.flags));
+    putU32(section, header.rawSize);
+    putU32(section, header.payloadSize);
+    return section + payload;
+}
+
+static bool unpackFileTable(const string& section, string& table) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(section.data());
+    if (section.size() < BLOCK_HEADER_SIZE) return false;
+    BlockHeader header = {static_cast<BlockCodec>(p[0]), p[1], getU32(p + 2), getU32(p + 6)};
+    if (header.codec == BlockCodec::End || header.payloadSize != section.size() - BLOCK_HEADER_SIZE) return false;
+    BlockDecoder decoder;
+    return decoder.decode(header, p + BLOCK_HEADER_SIZE, 0, nullptr, table);
+}
+
+bool hasFileTable(const ContainerInfo& info) {
+    for (const pair<uint32_t, string>& section : info.sections) {
+        if (section.first == SECTION_FILE_TABLE) return true;
+    }
+    return false;
+}
+
+bool findFileTable(const ContainerInfo& info, vector<ArchiveEntry>& entries) {
+    for (const pair<uint32_t, string>& section : info.sections) {
+        if (section.first != SECTION_FILE_TABLE) continue;
+        string table;
+        if (!unpackFileTable(section.second, table) || !decodeFileTable(table, info.originalSize, entries)) {
+            cerr << "Invalid file table, corrupted file!" << endl;
+            return false;
+        }
+        return true;
+    }
+    cerr << "The file is not an archive." << endl;
+    return false;
+}
+
+bool isTxtArchive(const string& compressedFile) {
+    // Archives are always written to a file with an index offset, so the silent pread path is enough
+    int fd = open(compressedFile.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    ContainerInfo info;
+    uint64_t fileSize;
+    bool indexed = readContainerIndex(fd, info, fileSize);
+    close(fd);
+    return indexed && hasFileTable(info);
+}
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Directory walk :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+// Entries below root/relative in name order, each directory before its contents.
+// skip is the archive being written, in case it lands inside the tree.
+static bool walkDirectory(const string& root, const string& relative, const struct stat& skip,
+                          vector<ArchiveEntry>& entries) {
+    string dirPath = relative.empty() ? root : root + "/" + relative;
+    DIR* dir = opendir(dirPath.c_str());
+    if (!dir) {
+        cerr << "Cannot open directory " << dirPath << ": " << strerror(errno) << endl;
+        return false;
+    }
+    vector<string> names;
+    while (dirent* item = readdir(dir)) {
+        string name = item->d_name;
+        if (name != "." && name != "..") names.push_back(name);
+    }
+    closedir(dir);
+    sort(names.begin(), names.end());
+
+    for (const string& name : names) {
+        string path = relative.empty() ? name : relative + "/" + name;
+        struct stat st;
+        if (lstat((root + "/" + path).c_str(), &st) != 0) {
+            cerr << "Cannot read " << path << ": " << strerror(errno) << endl;
+            return false;
+        }
+        if (st.st_dev == skip.st_dev && st.st_ino == skip.st_ino) continue;
+
+        ArchiveEntry entry = {ArchiveEntryType::File, static_cast<uint32_t>(st.st_mode & ARCHIVE_MODE_MASK), 0, path, 0};
+        if (S_ISDIR(st.st_mode)) {
+            entry.type = ArchiveEntryType::Directory;
+            entries.push_back(entry);
+            if (!walkDirectory(root, path, skip, entries)) return false;
+        } else if (S_ISREG(st.st_mode)) {
+            entry.size = static_cast<uint64_t>(st.st_size);
+            entries.push_back(entry);
+        } else {
+            cout << "Skipping " << path << " (not a regular file or directory)" << endl;
+        }
+    }
+    return true;
+}
+
+// Solid archives group files by extension, then by name, so similar files share blocks
+static string solidKey(const string& path) {
+    size_t slash = path.rfind('/');
+    string name = slash == string::npos ? path : path.substr(slash + 1);
+    size_t dot = name.rfind('.');
+    string extension = dot == string::npos || dot == 0 ? string() : name.substr(dot + 1);
+    return extension + '\0' + name + '\0' + path;
+}
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Block source :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+namespace {
+
+// Cuts the file contents, in table order, into blocks
+class BlockSource {
+public:
+    BlockSource(const string& root, const vector<ArchiveEntry>& entries, size_t blockSize, bool solid)
+        : root(root), entries(entries), blockSize(blockSize), solid(solid), index(0), remaining(0), error(false) {}
+
+    // Next block, false at the end of the data or on errors
+    bool next(string& block) {
+        block.clear();
+        while (block.size() < blockSize) {
+            if (remaining == 0) {
+                // Without solid every file starts a new block
+                if (!block.empty() && !solid) break;
+                if (!openNext()) break;
+                continue;
+            }
+            size_t at = block.size();
+            size_t n = static_cast<size_t>(min(static_cast<uint64_t>(blockSize - at), remaining));
+            block.resize(at + n);
+            if (!file.read(&block[at], n)) {
+                cerr << entries[index - 1].path << " changed while it was archived!" << endl;
+                error = true;
+                return false;
+            }
+            remaining -= n;
+        }
+        return !block.empty() && !error;
+    }
+
+    bool failed() const { return error; }
+
+private:
+    const string& root;
+    const vector<ArchiveEntry>& entries;
+    size_t blockSize;
+    bool solid;
+    size_t index;         // Entry after the open file
+    uint64_t remaining;   // Bytes of the open file still to read
+    ifstream file;
+    bool error;
+
+    bool openNext() {
+        while (index < entries.size()) {
+            const ArchiveEntry& entry = entries[index++];
+            if (entry.type != ArchiveEntryType::File || entry.size == 0) continue;
+            file.close();
+            file.clear();
+            file.open(root + "/" + entry.path, ios::in | ios::binary);
+            if (!file.is_open()) {
+                cerr << "Cannot open " << entry.path << endl;
+                error = true;
+                return false;
+            }
+            remaining = entry.size;
+            return true;
+        }
+        return false;
+    }
+};
+
+// The data of the archive read back at any position, through the files it came from. The
+// deduplicator compares a repeated chunk with its first copy through it.
+class ArchiveHistory : public streambuf {
+public:
+    ArchiveHistory(const string& root, const vector<ArchiveEntry>& entries) : root(root), position(0), current(-1) {
+        for (const ArchiveEntry& entry : entries) {
+            if (entry.type == ArchiveEntryType::File && entry.size > 0) files.push_back(&entry);
+        }
+    }
+
+protected:
+    pos_type seekoff(off_type off, ios_base::seekdir dir, ios_base::openmode) override {
+        if (dir == ios_base::cur) off += position;
+        else if (dir != ios_base::beg) return pos_type(off_type(-1));
+        position = static_cast<uint64_t>(off);
+        return pos_type(off);
+    }
+
+    pos_type seekpos(pos_type pos, ios_base::openmode mode) override {
+        return seekoff(off_type(pos), ios_base::beg, mode);
+    }
+
+    streamsize xsgetn(char* s, streamsize n) override {
+        streamsize done = 0;
+        while (done < n) {
+            // The file holding position, files are in data order
+            vector<const ArchiveEntry*>::const_iterator it = upper_bound(
+                files.begin(), files.end(), position,
+                [](uint64_t value, const ArchiveEntry* entry) { return value < entry->offset; });
+            if (it == files.begin()) break;
+            const ArchiveEntry& entry = **--it;
+            if (position >= entry.offset + entry.size) break;
+
+            int index = static_cast<int>(it - files.begin());
+            if (index != current) {
+                file.close();
+                file.clear();
+                file.open(root + "/" + entry.path, ios::in | ios::binary);
+                current = index;
+            }
+            size_t count = static_cast<size_t>(min(static_cast<uint64_t>(n - done), entry.offset + entry.size - position));
+            file.clear();
+            file.seekg(static_cast<streamoff>(position - entry.offset));
+            if (!file.read(s + done, static_cast<streamsize>(count))) break;
+            done += static_cast<streamsize>(count);
+            position += count;
+        }
+        return done;
+    }
+
+private:
+    const string& root;
+    vector<const ArchiveEntry*> files;
+    uint64_t position;
+    int current;
+    ifstream file;
+};
+
+struct BlockJob {
+    string raw;
+    vector<FarMatch> far;
+    BlockHeader header;
+    string payload;
+};
+
+} // namespace
+
+// Deduplication has to see the blocks in order, so it runs here rather than on the pool
+static void readBatch(BlockSource& source, size_t count, ChunkDeduplicator* dedup, uint64_t& position,
+                      vector<BlockJob>& batch) {
+    batch.clear();
+    string block;
+    while (batch.size() < count && source.next(block)) {
+        batch.push_back(BlockJob());
+        BlockJob& job = batch.back();
+        job.raw.swap(block);
+        if (dedup) dedup->process(reinterpret_cast<const uint8_t*>(job.raw.data()), job.raw.size(), position, job.far);
+        position += job.raw.size();
+    }
+}
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Export Functions :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+void compress_txt_archive(const string& inputDir, const string& outputFile, int level, bool solid, bool dedup,
+                          unsigned threads) {
+    ofstream outFile(outputFile, ios::out | ios::binary);
+    if (!outFile.is_open()) {
+        cerr << "Error opening files!" << endl;
+        return;
+    }
+    struct stat self;
+    if (stat(outputFile.c_str(), &self) != 0) memset(&self, 0, sizeof(self));
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    // Step 1: The tree, directories first, then the files in the order their data is stored
+    string root = inputDir;
+    while (root.size() > 1 && root.back() == '/') root.pop_back();
+    vector<ArchiveEntry> entries;
+    if (!walkDirectory(root, "", self, entries)) return;
+    vector<ArchiveEntry>::iterator files = stable_partition(entries.begin(), entries.end(), [](const ArchiveEntry& e) {
+        return e.type == ArchiveEntryType::Directory;
+    });
+    if (solid) {
+        sort(files, entries.end(), [](const ArchiveEntry& a, const ArchiveEntry& b) {
+            return solidKey(a.path) < solidKey(b.path);
+        });
+    }
+    uint64_t offset = 0;
+    for (ArchiveEntry& entry : entries) {
+        entry.offset = offset;
+        offset += entry.size;
+    }
+
+    LevelParams params = levelParams(level);
+    ThreadPool pool(threads);
+    ContainerWriter writer(outFile, params.codec, static_cast<uint32_t>(params.blockSize));
+    writer.addSection(SECTION_FILE_TABLE, packFileTable(params, encodeFileTable(entries)));
+
+    // Step 2: Blocks compress in batches on the pool while the next batch is read, and are written in order
+    BlockSource source(root, entries, params.blockSize, solid);
+    size_t batchSize = pool.size() * ARCHIVE_BATCH_PER_THREAD;
+    ArchiveHistory historyBuffer(root, entries);
+    istream history(&historyBuffer);
+    ChunkDeduplicator deduplicator(history);
+    ChunkDeduplicator* chunks = dedup ? &deduplicator : nullptr;
+    vector<BlockJob> current, next;
+    size_t blocks = 0;
+    uint64_t position = 0;
+    readBatch(source, batchSize, chunks, position, current);
+    while (!current.empty()) {
+        for (BlockJob& job : current) {
+            pool.submit([&params, &job]() {
+                compressBlockFar(params, reinterpret_cast<const uint8_t*>(job.raw.data()), job.raw.size(), job.far,
+                                 job.header, job.payload);
+            });
+        }
+        readBatch(source, batchSize, chunks, position, next);
+        pool.wait();
+        if (source.failed()) return;
+
+        for (const BlockJob& job : current) {
+            writer.writeBlock(job.header, job.payload, reinterpret_cast<const uint8_t*>(job.raw.data()), job.raw.size());
+        }
+        blocks += current.size();
+        current.swap(next);
+    }
+    if (source.failed()) return;
+
+    if (!writer.finish()) {
+        cerr << "Error writing compressed file!" << endl;
+        return;
+    }
+
+    size_t directories = static_cast<size_t>(files - entries.begin());
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "Archived " << entries.size() - directories << " files and " << directories << " directories"
+         << (solid ? " (solid)" : "") << ": " << writer.rawBytes() << " -> " << writer.bytesWritten() << " bytes in "
+         << blocks << " blocks on " << pool.size() << " thread(s)";
+    if (seconds > 0) cout << " at " << static_cast<int>(writer.rawBytes() / seconds / 1e6) << " MB/s";
+    cout << endl;
+    if (dedup) {
+        cout << "Deduplicated " << deduplicator.duplicateBytes() << " bytes, " << deduplicator.uniqueChunks()
+             << " unique chunks" << endl;
+    }
+    cout << "Compression complete. Output written to " << outputFile << endl;
+}
+
+
+// Relative, without empty, "." or ".." parts, so nothing lands outside the output directory
+static bool safePath(const string& path) {
+    if (path.empty() || path[0] == '/') return false;
+    size_t begin = 0;
+    while (true) {
+        size_t end = path.find('/', begin);
+        string part = path.substr(begin, end == string::npos ? string::npos : end - begin);
+        if (part.empty() || part == "." || part == "..") return false;
+        if (end == string::npos) return true;
+        begin = end + 1;
+    }
+}
+
+// mkdir -p
+static bool makeDirectories(const string& path) {
+    size_t pos = 0;
+    while (true) {
+        pos = path.find('/', pos + 1);
+        string prefix = path.substr(0, pos);
+        if (mkdir(prefix.c_str(), 0755) != 0 && errno != EEXIST) {
+            cerr << "Cannot create directory " << prefix << ": " << strerror(errno) << endl;
+            return false;
+        }
+        if (pos == string::npos) return true;
+    }
+}
+
+bool extract_txt_archive(const string& compressedFile, const string& outputDir) {
+    ifstream inFile(compressedFile, ios::binary);
+    if (!inFile.is_open()) {
+        cerr << "Error opening input file." << endl;
+        return false;
+    }
+
+    char head[CONTAINER_MAGIC_SIZE + 2];
+    if (!inFile.read(head, sizeof(head)) || containerVersion(head, sizeof(head)) < 1) {
+        cerr << "The file is not an archive." << endl;
+        return false;
+    }
+    inFile.seekg(0);
+
+    // Both report their own errors
+    ContainerInfo info;
+    vector<ArchiveEntry> table;
+    if (!readContainerInfo(inFile, info) || !findFileTable(info, table)) return false;
+
+    // The file table is input like any other: no paths out of outputDir, no setuid / setgid bits
+    vector<ArchiveEntry> entries;
+    for (const ArchiveEntry& entry : table) {
+        if (!safePath(entry.path)) {
+            cerr << "Unsafe path " << entry.path << " in the file table, refusing to extract." << endl;
+            return false;
+        }
+        if (entry.mode & ~ARCHIVE_MODE_MASK) {
+            cerr << "Skipping " << entry.path << ": mode " << oct << entry.mode << dec << " has bits outside "
+                 << oct << ARCHIVE_MODE_MASK << dec << endl;
+            continue;
+        }
+        entries.push_back(entry);
+    }
+
+    // Step 1: The directories, and the files they hold in data order
+    if (!makeDirectories(outputDir)) return false;
+    vector<ExtractTarget> targets;
+    for (const ArchiveEntry& entry : entries) {
+        string path = outputDir + "/" + entry.path;
+        if (entry.type == ArchiveEntryType::Directory) {
+            if (!makeDirectories(path)) return false;
+            continue;
+        }
+        if (!makeDirectories(path.substr(0, path.rfind('/')))) return false;
+        ExtractTarget target = {path, entry.offset, entry.size};
+        targets.push_back(target);
+    }
+
+    // Step 2: Every block decoded in parallel straight into the files it covers
+    // A failed block leaves its files partly written, none of them is kept
+    if (!extract_txt_blocks(compressedFile, targets)) {
+        cerr << "Error extracting " << compressedFile << endl;
+        for (const ExtractTarget& target : targets) remove(target.path.c_str());
+        return false;
+    }
+
+    // Step 3: Permissions last, directories deepest first, a read only directory would keep its files out
+    for (vector<ArchiveEntry>::const_reverse_iterator it = entries.rbegin(); it != entries.rend(); ++it) {
+        chmod((outputDir + "/" + it->path).c_str(), static_cast<mode_t>(it->mode));
+    }
+
+    cout << "Extracted " << targets.size() << " files and " << entries.size() - targets.size() << " directories ("
+         << info.originalSize << " bytes) to " << outputDir << endl;
+    return true;
+}
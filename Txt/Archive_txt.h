@@ -0,0 +1,70 @@
+#ifndef TXT_ARCHIVE_H
+#define TXT_ARCHIVE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Container_txt.h"
+
+/*
+Multi-file archives: a directory tree packed into one block based container. The blocks hold
+the contents of every file one after the other, the file table is an index section holding one
+block (block header and payload, compressed like the data) with
+    u32 entry count, then per entry
+        u8 type, u32 permission bits, u64 size, u32 path length, path
+Paths are relative to the archived directory, separated by '/'. Files are listed in the order
+of their data, so the offset of a file is the sum of the sizes before it.
+
+Without --solid every file starts a new block and decodes on its own. With --solid the files
+form one stream cut at the block size of the level: small files share blocks, and with them the
+LZ window and the Huffman table. Files are then ordered by extension and name, so similar files
+end up next to each other.
+
+With --dedup the blocks are cut into content defined chunks first and chunks already stored
+earlier in the archive become far matches (see Dedup_txt.h), so a tree holding several nearly
+identical snapshots stores the shared content once.
+*/
+
+const uint32_t SECTION_FILE_TABLE = 2;
+
+// Level used when none is given on the command line
+const int ARCHIVE_DEFAULT_LEVEL = 6;
+
+enum class ArchiveEntryType : uint8_t {
+    File = 0,
+    Directory = 1,
+};
+
+// Mode bits an archive stores and extraction applies: permissions and the sticky bit, never
+// setuid / setgid. Entries with other bits set are skipped on extraction.
+const uint32_t ARCHIVE_MODE_MASK = 01777;
+
+struct ArchiveEntry {
+    ArchiveEntryType type;
+    uint32_t mode;        // Permission bits, within ARCHIVE_MODE_MASK
+    uint64_t size;        // 0 for directories
+    std::string path;
+    uint64_t offset;      // Offset of the data in the container, derived from the sizes
+};
+
+std::string encodeFileTable(const std::vector<ArchiveEntry>& entries);
+bool decodeFileTable(const std::string& data, uint64_t originalSize, std::vector<ArchiveEntry>& entries);
+
+// Whether the container has a file table, a single file has none
+bool hasFileTable(const ContainerInfo& info);
+
+// The file table of a container, false (reported) if it has none or it does not decode
+bool findFileTable(const ContainerInfo& info, std::vector<ArchiveEntry>& entries);
+
+// Whether compressedFile is an archive, a probe that reports nothing
+bool isTxtArchive(const std::string& compressedFile);
+
+// Pack inputDir; threads 0 compresses on every core
+void compress_txt_archive(const std::string& inputDir, const std::string& outputFile, int level, bool solid,
+                          bool dedup = false, unsigned threads = 0);
+
+// Recreate the archived tree under outputDir, false on errors. Files of a failed extraction are removed.
+bool extract_txt_archive(const std::string& compressedFile, const std::string& outputDir);
+
+#endif
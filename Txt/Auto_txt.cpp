@@ -0,0 +1,134 @@
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include "Auto_txt.h"
+#include "Compress_txt.h"
+#include "Levels_txt.h"
+
+using namespace std;
+
+
+static const size_t AUTO_BLOCK_SIZE = 1 << 20;
+static const size_t SAMPLE_WINDOWS = 4;
+static const size_t SAMPLE_WINDOW_SIZE = 4096;
+static const int MATCH_HASH_BITS = 12;
+
+// Engines used for the blocks auto mode hands to LZ and BWT
+static const int AUTO_LZ_LEVEL = 6;
+static const int AUTO_BWT_LEVEL = 17;
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Function to estimate entropy and match density from sampled windows :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+BlockEstimate estimateBlock(const uint8_t* data, size_t size) {
+    BlockEstimate estimate = {0.0, 0.0};
+    if (size == 0) return estimate;
+
+    size_t windows = SAMPLE_WINDOWS;
+    size_t window = SAMPLE_WINDOW_SIZE;
+    if (size <= windows * window) {
+        windows = 1;
+        window = size;
+    }
+
+    vector<uint64_t> hist(256, 0);
+    vector<uint64_t> seen(1 << MATCH_HASH_BITS, 0);
+    uint64_t sampled = 0, positions = 0, repeats = 0;
+
+    for (size_t w = 0; w < windows; ++w) {
+        size_t start = windows == 1 ? 0 : w * (size - window) / (windows - 1);
+        const uint8_t* p = data + start;
+
+        // Step 1: Order-0 statistics straight from the txt histogram
+        vector<uint32_t> counts = countFrequencies(p, window);
+        for (int c = 0; c < 256; ++c) hist[c] += counts[c];
+        sampled += window;
+
+        // Step 2: Repeated 8 byte sequences, remembered across windows. Shorter ones
+        // repeat by chance in small alphabets without LZ gaining anything from them.
+        for (size_t i = 0; i + 8 <= window; ++i) {
+            uint64_t v;
+            memcpy(&v, p + i, sizeof(v));
+            uint32_t h = static_cast<uint32_t>((v * 0x9E3779B97F4A7C15ull) >> (64 - MATCH_HASH_BITS));
+            if (seen[h] == v) ++repeats;
+            seen[h] = v;
+            ++positions;
+        }
+    }
+
+    for (int c = 0; c < 256; ++c) {
+        if (!hist[c]) continue;
+        double p = static_cast<double>(hist[c]) / sampled;
+        estimate.entropy -= p * log2(p);
+    }
+    estimate.matchDensity = positions ? static_cast<double>(repeats) / positions : 0.0;
+    return estimate;
+}
+
+BlockCodec chooseCodec(const BlockEstimate& estimate) {
+    if (estimate.matchDensity < 0.02) {
+        return estimate.entropy > 7.5 ? BlockCodec::Stored : BlockCodec::Huffman;
+    }
+    if (estimate.matchDensity > 0.35 || estimate.entropy > 6.0) {
+        return BlockCodec::Lz;
+    }
+    return BlockCodec::Bwt;
+}
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Export Function :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+void compress_txt_auto(const string& inputFile, const string& outputFile, bool longDistance, bool lineIndex) {
+    ifstream inFile(inputFile, ios::in | ios::binary);
+    ofstream outFile(outputFile, ios::out | ios::binary);
+    ifstream history(inputFile, ios::in | ios::binary);
+    if (!inFile.is_open() || !outFile.is_open() || !history.is_open()) {
+        cerr << "Error opening files!" << endl;
+        return;
+    }
+    LongDistanceMatcher matcher(history);
+    vector<FarMatch> far;
+
+    ContainerWriter writer(outFile, BlockCodec::End, static_cast<uint32_t>(AUTO_BLOCK_SIZE));
+    if (lineIndex) writer.indexLines();
+
+    string block, payload;
+    BlockHeader header;
+    size_t chosen[5] = {0, 0, 0, 0, 0};
+    while (true) {
+        block.resize(AUTO_BLOCK_SIZE);
+        inFile.read(&block[0], block.size());
+        block.resize(static_cast<size_t>(inFile.gcount()));
+        if (block.empty()) break;
+
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(block.data());
+        BlockCodec codec = chooseCodec(estimateBlock(data, block.size()));
+
+        LevelParams params = levelParams(codec == BlockCodec::Bwt ? AUTO_BWT_LEVEL : AUTO_LZ_LEVEL);
+        params.codec = codec;
+        if (longDistance) matcher.process(data, block.size(), writer.rawBytes(), far);
+        compressBlockFar(params, data, block.size(), far, header, payload);
+        writer.writeBlock(header, payload, data, block.size());
+        chosen[static_cast<int>(header.codec)]++;
+    }
+
+    if (!writer.finish()) {
+        cerr << "Error writing compressed file!" << endl;
+        return;
+    }
+
+    cout << "Auto: " << chosen[static_cast<int>(BlockCodec::Stored)] << " stored, "
+         << chosen[static_cast<int>(BlockCodec::Huffman)] << " Huffman, "
+         << chosen[static_cast<int>(BlockCodec::Lz)] << " LZ, "
+         << chosen[static_cast<int>(BlockCodec::Bwt)] << " BWT block(s)" << endl;
+    cout << "Compression complete. Output written to " << outputFile << endl;
+}
@@ -0,0 +1,24 @@
+#ifndef TXT_AUTO_H
+#define TXT_AUTO_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "Container_txt.h"
+
+// Cheap per block statistics, taken from a few sampled windows instead of the whole block
+struct BlockEstimate {
+    double entropy;        // Order-0 entropy in bits per byte
+    double matchDensity;   // Fraction of sampled positions that repeat an earlier 8 byte sequence
+};
+
+BlockEstimate estimateBlock(const uint8_t* data, size_t size);
+
+// Stored for incompressible data, Huffman for skewed data without repeats,
+// LZ for repetitive data and BWT for text in between
+BlockCodec chooseCodec(const BlockEstimate& estimate);
+
+void compress_txt_auto(const std::string& inputFile, const std::string& outputFile,
+                       bool longDistance = false, bool lineIndex = false);
+
+#endif
@@ -0,0 +1,223 @@
+#include <algorithm>
+#include <cstring>
+#include "Bwt_txt.h"
+#include "Container_txt.h"
+#include "Huffman_txt.h"
+
+using namespace std;
+
+
+/*
+Block payload:
+    u32 primary index          row of the sorted rotations that holds the original block
+    code lengths               RUN_SYMBOLS symbols
+    bitstream                  MTF symbols, zero runs as bijective base 2 RUNA / RUNB digits, then EOB
+*/
+
+static const int RUNA = 0;
+static const int RUNB = 1;
+static const int EOB = 257;
+static const int RUN_SYMBOLS = 258;
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Function to sort the rotations of data + sentinel :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+// Rotation order of data followed by a unique smallest sentinel; entry 0 is always the sentinel
+static vector<int32_t> sortRotations(const uint8_t* data, size_t size) {
+    int32_t n = static_cast<int32_t>(size) + 1;
+    vector<int32_t> p(n), c(n), pn(n), cn(n);
+    vector<int32_t> cnt(max(n, 257), 0);
+
+    // Step 1: Sort by first symbol, the sentinel is symbol 0
+    for (int32_t i = 0; i < n; ++i) cnt[i < n - 1 ? data[i] + 1 : 0]++;
+    for (int i = 1; i < 257; ++i) cnt[i] += cnt[i - 1];
+    for (int32_t i = n - 1; i >= 0; --i) p[--cnt[i < n - 1 ? data[i] + 1 : 0]] = i;
+
+    c[p[0]] = 0;
+    int32_t classes = 1;
+    for (int32_t i = 1; i < n; ++i) {
+        int a = p[i] < n - 1 ? data[p[i]] + 1 : 0;
+        int b = p[i - 1] < n - 1 ? data[p[i - 1]] + 1 : 0;
+        if (a != b) ++classes;
+        c[p[i]] = classes - 1;
+    }
+
+    // Step 2: Double the sorted prefix length until all rotations are distinct
+    for (int32_t h = 1; classes < n; h <<= 1) {
+        for (int32_t i = 0; i < n; ++i) {
+            pn[i] = p[i] - h;
+            if (pn[i] < 0) pn[i] += n;
+        }
+        fill(cnt.begin(), cnt.begin() + classes, 0);
+        for (int32_t i = 0; i < n; ++i) cnt[c[pn[i]]]++;
+        for (int32_t i = 1; i < classes; ++i) cnt[i] += cnt[i - 1];
+        for (int32_t i = n - 1; i >= 0; --i) p[--cnt[c[pn[i]]]] = pn[i];
+
+        cn[p[0]] = 0;
+        classes = 1;
+        for (int32_t i = 1; i < n; ++i) {
+            int32_t a = p[i] + h, b = p[i - 1] + h;
+            if (a >= n) a -= n;
+            if (b >= n) b -= n;
+            if (c[p[i]] != c[p[i - 1]] || c[a] != c[b]) ++classes;
+            cn[p[i]] = classes - 1;
+        }
+        c.swap(cn);
+    }
+    return p;
+}
+
+vector<int32_t> buildSuffixArray(const uint8_t* data, size_t size) {
+    vector<int32_t> rotations = sortRotations(data, size);
+    return vector<int32_t>(rotations.begin() + 1, rotations.end());
+}
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Encoder :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+static void pushRun(vector<uint16_t>& symbols, uint32_t run) {
+    if (run == 0) return;
+    --run;
+    while (true) {
+        symbols.push_back((run & 1) ? RUNB : RUNA);
+        if (run < 2) break;
+        run = (run - 2) / 2;
+    }
+}
+
+void encodeBwtBlock(const uint8_t* data, size_t size, string& out) {
+    // Step 1: Last column of the sorted rotations, sentinel left out
+    vector<int32_t> rotations = sortRotations(data, size);
+    vector<uint8_t> last(size);
+    uint32_t primary = 0;
+    size_t j = 0;
+    for (size_t i = 0; i < rotations.size(); ++i) {
+        if (rotations[i] == 0) {
+            primary = static_cast<uint32_t>(i);
+        } else {
+            last[j++] = data[rotations[i] - 1];
+        }
+    }
+    vector<int32_t>().swap(rotations);
+
+    // Step 2: Move-to-front with zero runs
+    vector<uint16_t> symbols;
+    symbols.reserve(size / 2 + 1);
+    uint8_t order[256];
+    for (int i = 0; i < 256; ++i) order[i] = static_cast<uint8_t>(i);
+    uint32_t run = 0;
+    for (size_t i = 0; i < size; ++i) {
+        uint8_t c = last[i];
+        if (order[0] == c) {
+            ++run;
+            continue;
+        }
+        pushRun(symbols, run);
+        run = 0;
+        int idx = 1;
+        while (order[idx] != c) ++idx;
+        memmove(order + 1, order, idx);
+        order[0] = c;
+        symbols.push_back(static_cast<uint16_t>(idx + 1));
+    }
+    pushRun(symbols, run);
+    symbols.push_back(EOB);
+
+    // Step 3: Huffman code the symbols
+    vector<uint32_t> freqs(RUN_SYMBOLS, 0);
+    for (uint16_t s : symbols) freqs[s]++;
+    vector<uint8_t> lengths = buildCodeLengths(freqs, HUFFMAN_MAX_BITS);
+    vector<uint32_t> codes = buildCanonicalCodes(lengths);
+
+    putU32(out, primary);
+    writeCodeLengths(out, lengths);
+    BitWriter writer(out);
+    for (uint16_t s : symbols) writer.put(codes[s], lengths[s]);
+    writer.flush();
+}
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Decoder :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+bool decodeBwtBlock(const uint8_t* data, size_t size, size_t rawSize, string& out) {
+    if (size < 4) return false;
+    uint32_t primary = getU32(data);
+    vector<uint8_t> lengths;
+    if (!readCodeLengths(data + 4, size - 4, RUN_SYMBOLS, lengths)) return false;
+    HuffmanDecoder decoder;
+    if (!decoder.init(lengths)) return false;
+    if (primary > rawSize || (rawSize > 0 && primary == 0)) return false;
+
+    // Step 1: Undo Huffman, zero runs and move-to-front
+    size_t tableSize = 4 + codeTableSize(RUN_SYMBOLS);
+    BitReader reader(data + tableSize, size - tableSize);
+    vector<uint8_t> last;
+    last.reserve(rawSize);
+    uint8_t order[256];
+    for (int i = 0; i < 256; ++i) order[i] = static_cast<uint8_t>(i);
+    uint64_t run = 0, weight = 1;
+    while (true) {
+        int sym = decoder.decode(reader);
+        if (sym < 0 || reader.exhausted()) return false;
+        if (sym == RUNA || sym == RUNB) {
+            run += (sym == RUNA ? 1 : 2) * weight;
+            weight <<= 1;
+            if (run > rawSize) return false;
+            continue;
+        }
+        if (last.size() + run > rawSize) return false;
+        last.insert(last.end(), run, order[0]);
+        run = 0;
+        weight = 1;
+        if (sym == EOB) break;
+
+        int idx = sym - 1;
+        uint8_t c = order[idx];
+        memmove(order + 1, order, idx);
+        order[0] = c;
+        if (last.size() == rawSize) return false;
+        last.push_back(c);
+    }
+    if (last.size() != rawSize) return false;
+
+    // Step 2: Inverse BWT through the LF mapping, the sentinel sits at the primary row
+    size_t n = rawSize + 1;
+    uint32_t base[256];
+    uint32_t counts[256] = {0};
+    for (uint8_t c : last) counts[c]++;
+    uint32_t sum = 1;
+    for (int c = 0; c < 256; ++c) {
+        base[c] = sum;
+        sum += counts[c];
+    }
+
+    vector<uint32_t> next(n);
+    next[primary] = 0;
+    for (size_t i = 0, k = 0; i < n; ++i) {
+        if (i == primary) continue;
+        uint8_t c = last[k++];
+        next[i] = base[c]++;
+    }
+
+    size_t start = out.size();
+    out.resize(start + rawSize);
+    size_t row = 0;
+    for (size_t k = rawSize; k-- > 0;) {
+        if (row == primary) return false;
+        out[start + k] = static_cast<char>(last[row < primary ? row : row - 1]);
+        row = next[row];
+    }
+    return true;
+}
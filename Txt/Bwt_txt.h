@@ -0,0 +1,17 @@
+#ifndef TXT_BWT_H
+#define TXT_BWT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Burrows-Wheeler block codec: BWT, move-to-front, zero run coding and one Huffman table.
+
+// Suffix array of data (prefix doubling with counting sorts, O(n log n))
+std::vector<int32_t> buildSuffixArray(const uint8_t* data, size_t size);
+
+void encodeBwtBlock(const uint8_t* data, size_t size, std::string& out);
+bool decodeBwtBlock(const uint8_t* data, size_t size, size_t rawSize, std::string& out);
+
+#endif
@@ -0,0 +1,257 @@
+#include <cstring>
+#include "Checksum_txt.h"
+
+using namespace std;
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+CRC-32 :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+namespace {
+
+struct Crc32Table {
+    uint32_t values[256];
+
+    Crc32Table() {
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            values[n] = c;
+        }
+    }
+};
+
+} // namespace
+
+static const Crc32Table CRC32;
+
+uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t size) {
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i) crc = CRC32.values[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+CRC-32C, portable :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+// Slicing-by-8: values[k][b] is the CRC of byte b followed by k zero bytes, so eight input
+// bytes take eight independent lookups instead of a chain of eight dependent ones.
+namespace {
+
+struct Crc32cTables {
+    uint32_t values[8][256];
+
+    Crc32cTables() {
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0x82F63B78u ^ (c >> 1) : c >> 1;
+            values[0][n] = c;
+        }
+        for (uint32_t n = 0; n < 256; ++n) {
+            for (int k = 1; k < 8; ++k) {
+                uint32_t c = values[k - 1][n];
+                values[k][n] = values[0][c & 0xFF] ^ (c >> 8);
+            }
+        }
+    }
+};
+
+} // namespace
+
+static const Crc32cTables CRC32C;
+
+static uint32_t crc32cPortable(uint32_t crc, const uint8_t* data, size_t size) {
+    while (size >= 8) {
+        uint32_t lo = crc ^ (static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+                             (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24));
+        crc = CRC32C.values[7][lo & 0xFF] ^ CRC32C.values[6][(lo >> 8) & 0xFF] ^
+              CRC32C.values[5][(lo >> 16) & 0xFF] ^ CRC32C.values[4][lo >> 24] ^
+              CRC32C.values[3][data[4]] ^ CRC32C.values[2][data[5]] ^
+              CRC32C.values[1][data[6]] ^ CRC32C.values[0][data[7]];
+        data += 8;
+        size -= 8;
+    }
+    while (size--) crc = CRC32C.values[0][(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+    return crc;
+}
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+CRC-32C zero operators :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+// Appending n zero bytes to the CRC register multiplies it by x^(8n) modulo the polynomial
+// (as zlib's crc32_combine). Bit 31 is x^0 since the CRC is reflected.
+static uint32_t multiplyModP(uint32_t a, uint32_t b) {
+    uint32_t product = 0;
+    for (uint32_t m = 1u << 31; m; m >>= 1) {
+        if (a & m) product ^= b;
+        b = (b & 1) ? (b >> 1) ^ 0x82F63B78u : b >> 1;
+    }
+    return product;
+}
+
+// x^(8 * size) modulo the polynomial, by squaring x^1 into x^2, x^4, x^8, ...
+static uint32_t zeroBytesOperator(uint64_t size) {
+    uint32_t power = 1u << 30;
+    for (int k = 0; k < 3; ++k) power = multiplyModP(power, power);
+
+    uint32_t op = 1u << 31;
+    for (; size; size >>= 1) {
+        if (size & 1) op = multiplyModP(power, op);
+        power = multiplyModP(power, power);
+    }
+    return op;
+}
+
+uint32_t crc32cCombine(uint32_t crcA, uint32_t crcB, uint64_t sizeB) {
+    return multiplyModP(zeroBytesOperator(sizeB), crcA) ^ crcB;
+}
+
+// The same operator for one fixed size, as byte tables so applying it takes four lookups
+namespace {
+
+struct Crc32cShift {
+    uint32_t values[4][256];
+
+    explicit Crc32cShift(uint64_t size) {
+        uint32_t op = zeroBytesOperator(size);
+        for (int k = 0; k < 4; ++k) {
+            for (uint32_t n = 0; n < 256; ++n) values[k][n] = multiplyModP(op, n << (8 * k));
+        }
+    }
+
+    uint32_t apply(uint32_t crc) const {
+        return values[0][crc & 0xFF] ^ values[1][(crc >> 8) & 0xFF] ^
+               values[2][(crc >> 16) & 0xFF] ^ values[3][crc >> 24];
+    }
+};
+
+} // namespace
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+CRC-32C, hardware :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+// One CRC instruction has a latency of about three cycles but the CPU can start one per
+// cycle, so three independent CRCs run over three neighbouring lanes and are joined by
+// shifting the first two over the lanes that follow them.
+static const size_t LONG_LANE = 8192;
+static const size_t SHORT_LANE = 256;
+
+#if defined(__x86_64__) && defined(__GNUC__)
+
+#include <nmmintrin.h>
+#define CRC32C_HARDWARE "sse4.2"
+#define CRC32C_TARGET __attribute__((target("sse4.2")))
+
+CRC32C_TARGET static inline uint32_t crc32cWord(uint32_t crc, const uint8_t* data) {
+    uint64_t v;
+    memcpy(&v, data, 8);
+    return static_cast<uint32_t>(_mm_crc32_u64(crc, v));
+}
+
+CRC32C_TARGET static inline uint32_t crc32cByte(uint32_t crc, uint8_t b) {
+    return _mm_crc32_u8(crc, b);
+}
+
+static bool hasCrc32cHardware() {
+    return __builtin_cpu_supports("sse4.2");
+}
+
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+
+#include <arm_acle.h>
+#define CRC32C_HARDWARE "armv8 crc"
+#define CRC32C_TARGET
+
+static inline uint32_t crc32cWord(uint32_t crc, const uint8_t* data) {
+    uint64_t v;
+    memcpy(&v, data, 8);
+    return __crc32cd(crc, v);
+}
+
+static inline uint32_t crc32cByte(uint32_t crc, uint8_t b) {
+    return __crc32cb(crc, b);
+}
+
+// The compiler only defines __ARM_FEATURE_CRC32 when every target CPU has the instructions
+static bool hasCrc32cHardware() {
+    return true;
+}
+
+#endif
+
+#ifdef CRC32C_HARDWARE
+
+static const Crc32cShift LONG_SHIFT(LONG_LANE);
+static const Crc32cShift SHORT_SHIFT(SHORT_LANE);
+
+// Only called once the CPU is known to have the instructions
+CRC32C_TARGET static uint32_t crc32cLanes(uint32_t crc, const uint8_t*& data, size_t& size,
+                                          size_t lane, const Crc32cShift& shift) {
+    while (size >= 3 * lane) {
+        uint32_t crc1 = 0, crc2 = 0;
+        for (const uint8_t* end = data + lane; data < end; data += 8) {
+            crc = crc32cWord(crc, data);
+            crc1 = crc32cWord(crc1, data + lane);
+            crc2 = crc32cWord(crc2, data + 2 * lane);
+        }
+        crc = shift.apply(crc) ^ crc1;
+        crc = shift.apply(crc) ^ crc2;
+        data += 2 * lane;
+        size -= 3 * lane;
+    }
+    return crc;
+}
+
+CRC32C_TARGET static uint32_t crc32cHardware(uint32_t crc, const uint8_t* data, size_t size) {
+    crc = crc32cLanes(crc, data, size, LONG_LANE, LONG_SHIFT);
+    crc = crc32cLanes(crc, data, size, SHORT_LANE, SHORT_SHIFT);
+    for (; size >= 8; data += 8, size -= 8) crc = crc32cWord(crc, data);
+    while (size--) crc = crc32cByte(crc, *data++);
+    return crc;
+}
+
+#endif
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+CRC-32C dispatch :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+typedef uint32_t (*Crc32cFunction)(uint32_t crc, const uint8_t* data, size_t size);
+
+static Crc32cFunction pickCrc32c() {
+#ifdef CRC32C_HARDWARE
+    if (hasCrc32cHardware()) return crc32cHardware;
+#endif
+    return crc32cPortable;
+}
+
+static const Crc32cFunction CRC32C_IMPLEMENTATION = pickCrc32c();
+
+uint32_t crc32cUpdate(uint32_t crc, const uint8_t* data, size_t size) {
+    return ~CRC32C_IMPLEMENTATION(~crc, data, size);
+}
+
+const char* crc32cImplementation() {
+#ifdef CRC32C_HARDWARE
+    if (CRC32C_IMPLEMENTATION == crc32cHardware) return CRC32C_HARDWARE;
+#endif
+    return "portable";
+}
@@ -0,0 +1,43 @@
+#ifndef TXT_CHECKSUM_H
+#define TXT_CHECKSUM_H
+
+#include <cstddef>
+#include <cstdint>
+
+// CRC-32 (IEEE, reflected 0xEDB88320) as used by gzip and zip.
+// Pass the previous result to continue a running checksum, 0 to start one.
+uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t size);
+
+// CRC-32C (Castagnoli, reflected 0x82F63B78) for the container block table. Runs on the
+// SSE4.2 / ARMv8 CRC instructions when the CPU has them, slicing-by-8 tables otherwise.
+uint32_t crc32cUpdate(uint32_t crc, const uint8_t* data, size_t size);
+
+// CRC-32C of A followed by B, from the checksums of both and the size of B
+uint32_t crc32cCombine(uint32_t crcA, uint32_t crcB, uint64_t sizeB);
+
+// Name of the CRC-32C implementation picked for this CPU
+const char* crc32cImplementation();
+
+// Bytes a decoder produces before it checksums them, small enough to still be in L1/L2
+const size_t CHECKSUM_CHUNK = 32 * 1024;
+
+// CRC-32C of a block taken while a decoder writes it, so verification needs no second
+// pass over memory. The decoder calls update() after every chunk it completes.
+class BlockChecksum {
+public:
+    BlockChecksum() : crc(0), done(0) {}
+
+    // data[0, size) is final, the bytes since the last call get checksummed
+    void update(const uint8_t* data, size_t size) {
+        crc = crc32cUpdate(crc, data + done, size - done);
+        done = size;
+    }
+
+    uint32_t value() const { return crc; }
+
+private:
+    uint32_t crc;
+    size_t done;
+};
+
+#endif
@@ -1,7 +1,22 @@
 #ifndef TXT_COMPRESSOR_H
 #define TXT_COMPRESSOR_H
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <vector>
+
+/*
+The default txt codec: order-0 Huffman, one code table per block, written as a container (see
+Container_txt.h) like every other mode, so the output carries the header, the block table and
+the checksums. Files from older releases (a bare Huffman tree followed by the bits) still
+decompress, see decompress_txt_file.
+*/
+
+const size_t HUFFMAN_BLOCK_SIZE = 1 << 20;
+
+// Byte histogram of a buffer, the counts the Huffman blocks build their code tables from
+std::vector<uint32_t> countFrequencies(const uint8_t* data, size_t size);
 
 void compress_txt_file(const std::string& inputFile, const std::string& outputFile);
 
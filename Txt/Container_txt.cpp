@@ -0,0 +1,492 @@
+#include <cstring>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Container_txt.h"
+#include "Huffman_txt.h"
+#include "Lz_txt.h"
+#include "Bwt_txt.h"
+#include "Ldm_txt.h"
+#include "Checksum_txt.h"
+
+using namespace std;
+
+
+static const char CONTAINER_MAGIC[CONTAINER_MAGIC_SIZE] = {'C', 'P', 'Z', 'F'};
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Little endian helpers :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+void putU32(string& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+    }
+}
+
+void putU64(string& out, uint64_t v) {
+    putU32(out, static_cast<uint32_t>(v));
+    putU32(out, static_cast<uint32_t>(v >> 32));
+}
+
+uint32_t getU32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+uint64_t getU64(const uint8_t* p) {
+    return getU32(p) | (static_cast<uint64_t>(getU32(p + 4)) << 32);
+}
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Framing :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+bool isContainerMagic(const char* bytes, size_t size) {
+    return size >= CONTAINER_MAGIC_SIZE && memcmp(bytes, CONTAINER_MAGIC, CONTAINER_MAGIC_SIZE) == 0;
+}
+
+int containerVersion(const char* bytes, size_t size) {
+    if (!isContainerMagic(bytes, size) || size < CONTAINER_MAGIC_SIZE + 2) return -1;
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(bytes) + CONTAINER_MAGIC_SIZE;
+    return p[0] | (p[1] << 8);
+}
+
+void writeBlock(ostream& out, const BlockHeader& header, const string& payload) {
+    string head;
+    head.push_back(static_cast<char>(header.codec));
+    head.push_back(static_cast<char>(header.flags));
+    putU32(head, header.rawSize);
+    putU32(head, static_cast<uint32_t>(payload.size()));
+    out.write(head.data(), head.size());
+    out.write(payload.data(), payload.size());
+}
+
+bool readBlockHeader(istream& in, BlockHeader& header) {
+    uint8_t head[BLOCK_HEADER_SIZE];
+    if (!in.read(reinterpret_cast<char*>(head), BLOCK_HEADER_SIZE)) return false;
+    header.codec = static_cast<BlockCodec>(head[0]);
+    header.flags = head[1];
+    header.rawSize = getU32(head + 2);
+    header.payloadSize = getU32(head + 6);
+    return true;
+}
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Container writer :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+ContainerWriter::ContainerWriter(ostream& out, BlockCodec codec, uint32_t blockSize)
+    : out(out)
+    , start(out.tellp())
+    , codec(codec)
+    , blockSize(blockSize)
+    , written(CONTAINER_HEADER_SIZE)
+    , originalSize(0)
+    , checksum(0)
+    , lineIndex(false)
+{
+    // Placeholder until finish() knows the sizes and where the index went
+    string head = header(0);
+    out.write(head.data(), head.size());
+}
+
+string ContainerWriter::header(uint64_t indexOffset) const {
+    string head(CONTAINER_MAGIC, CONTAINER_MAGIC_SIZE);
+    head.push_back(static_cast<char>(CONTAINER_VERSION & 0xFF));
+    head.push_back(static_cast<char>(CONTAINER_VERSION >> 8));
+    head.push_back(static_cast<char>(codec));
+    head.push_back(static_cast<char>(CONTAINER_FLAG_CHECKSUMS));
+    putU64(head, indexOffset ? originalSize : 0);
+    putU32(head, blockSize);
+    putU32(head, static_cast<uint32_t>(blocks.size()));
+    putU64(head, indexOffset);
+    return head;
+}
+
+void ContainerWriter::writeBlock(const BlockHeader& header, const string& payload, const uint8_t* raw, size_t rawSize) {
+    BlockEntry entry = {written, originalSize, header.rawSize, static_cast<uint32_t>(payload.size()),
+                        header.codec, header.flags, crc32cUpdate(0, raw, rawSize)};
+    blocks.push_back(entry);
+    checksum = crc32cCombine(checksum, entry.checksum, rawSize);
+    if (lineIndex) lines.push_back(lineCounter.add(raw, rawSize));
+    ::writeBlock(out, header, payload);
+    written += BLOCK_HEADER_SIZE + payload.size();
+    originalSize += header.rawSize;
+}
+
+void ContainerWriter::addSection(uint32_t tag, const string& data) {
+    sections.push_back(make_pair(tag, data));
+}
+
+bool ContainerWriter::finish() {
+    // Step 1: End block, so sequential readers know where the blocks stop
+    BlockHeader end = {BlockCodec::End, 0, 0, 0};
+    ::writeBlock(out, end, string());
+    written += BLOCK_HEADER_SIZE;
+
+    // Step 2: Block table and sections
+    if (lineIndex) addSection(SECTION_LINE_INDEX, encodeLineIndex(lines));
+    uint64_t indexOffset = written;
+    string index;
+    putU32(index, static_cast<uint32_t>(blocks.size()));
+    for (const BlockEntry& b : blocks) {
+        putU64(index, b.offset);
+        putU32(index, b.rawSize);
+        putU32(index, b.payloadSize);
+        index.push_back(static_cast<char>(b.codec));
+        index.push_back(static_cast<char>(b.flags));
+        putU32(index, b.checksum);
+    }
+    putU32(index, checksum);
+    for (const pair<uint32_t, string>& section : sections) {
+        putU32(index, section.first);
+        putU32(index, static_cast<uint32_t>(section.second.size()));
+        index += section.second;
+    }
+    putU32(index, 0);
+    out.write(index.data(), index.size());
+    written += index.size();
+
+    // Step 3: The real header, unless the output cannot seek (readers then scan the blocks)
+    if (start >= 0) {
+        string head = header(indexOffset);
+        out.seekp(start);
+        out.write(head.data(), head.size());
+        out.seekp(start + static_cast<streamoff>(written));
+    }
+    return static_cast<bool>(out);
+}
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Container reader :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+// Build the block table from the block headers, starting at offset first
+static bool scanBlocks(istream& in, streamoff base, uint64_t first, ContainerInfo& info) {
+    info.blocks.clear();
+    uint64_t offset = first, rawOffset = 0;
+    in.clear();
+    in.seekg(base + static_cast<streamoff>(first));
+
+    BlockHeader header;
+    while (readBlockHeader(in, header)) {
+        if (header.codec == BlockCodec::End) {
+            info.originalSize = rawOffset;
+            return true;
+        }
+        BlockEntry entry = {offset, rawOffset, header.rawSize, header.payloadSize, header.codec, header.flags, 0};
+        info.blocks.push_back(entry);
+        offset += BLOCK_HEADER_SIZE + header.payloadSize;
+        rawOffset += header.rawSize;
+        if (!in.seekg(header.payloadSize, ios::cur)) break;
+    }
+    cerr << "Missing end block, corrupted file!" << endl;
+    return false;
+}
+
+// Fields of the header, the block count is checked against the index
+static void parseHeader(const uint8_t* p, ContainerInfo& info, uint32_t& blockCount) {
+    info.codec = static_cast<BlockCodec>(p[6]);
+    info.flags = p[7];
+    info.originalSize = getU64(p + 8);
+    info.blockSize = getU32(p + 16);
+    blockCount = getU32(p + 20);
+    info.indexOffset = getU64(p + 24);
+}
+
+// Block table, whole data checksum and sections from the bytes following the index offset
+static bool parseIndex(const uint8_t* p, size_t size, uint32_t blockCount, ContainerInfo& info) {
+    if (size < 4 || getU32(p) != blockCount || blockCount > (size - 4) / INDEX_ENTRY_SIZE) return false;
+    size_t pos = 4;
+
+    uint64_t rawOffset = 0;
+    info.blocks.clear();
+    info.blocks.reserve(blockCount);
+    for (uint32_t i = 0; i < blockCount; ++i, pos += INDEX_ENTRY_SIZE) {
+        BlockEntry entry;
+        entry.offset = getU64(p + pos);
+        entry.rawOffset = rawOffset;
+        entry.rawSize = getU32(p + pos + 8);
+        entry.payloadSize = getU32(p + pos + 12);
+        entry.codec = static_cast<BlockCodec>(p[pos + 16]);
+        entry.flags = p[pos + 17];
+        entry.checksum = getU32(p + pos + 18);
+        info.blocks.push_back(entry);
+        rawOffset += entry.rawSize;
+    }
+    if (rawOffset != info.originalSize || size - pos < 4) return false;
+    info.checksum = getU32(p + pos);
+    pos += 4;
+
+    info.sections.clear();
+    while (true) {
+        if (size - pos < 4) return false;
+        uint32_t tag = getU32(p + pos);
+        pos += 4;
+        if (tag == 0) return true;
+        if (size - pos < 4 || getU32(p + pos) > size - pos - 4) return false;
+        uint32_t length = getU32(p + pos);
+        info.sections.push_back(make_pair(tag, string(reinterpret_cast<const char*>(p + pos + 4), length)));
+        pos += 4 + length;
+    }
+}
+
+// The index runs from the index offset to the end of the file
+static bool readIndex(istream& in, streamoff base, uint32_t blockCount, ContainerInfo& info) {
+    in.clear();
+    in.seekg(base + static_cast<streamoff>(info.indexOffset));
+    string index;
+    char buf[64 * 1024];
+    while (in.read(buf, sizeof(buf)) || in.gcount() > 0) index.append(buf, static_cast<size_t>(in.gcount()));
+    return parseIndex(reinterpret_cast<const uint8_t*>(index.data()), index.size(), blockCount, info);
+}
+
+bool readContainerInfo(istream& in, ContainerInfo& info) {
+    streamoff base = in.tellg();
+    char head[CONTAINER_HEADER_SIZE];
+    if (!in.read(head, CONTAINER_MAGIC_SIZE + 2)) return false;
+    int version = containerVersion(head, CONTAINER_MAGIC_SIZE + 2);
+    if (version < 1) return false;
+
+    info = ContainerInfo();
+    info.version = static_cast<uint16_t>(version);
+    info.codec = BlockCodec::End;
+    info.flags = 0;
+    info.originalSize = 0;
+    info.blockSize = 0;
+    info.indexOffset = 0;
+    info.checksum = 0;
+
+    if (version > CONTAINER_VERSION) {
+        cerr << "Container version " << version << " is newer than this build (" << CONTAINER_VERSION << ")" << endl;
+        return false;
+    }
+
+    if (!in.read(head + CONTAINER_MAGIC_SIZE + 2, CONTAINER_HEADER_SIZE - CONTAINER_MAGIC_SIZE - 2)) {
+        cerr << "Truncated header, corrupted file!" << endl;
+        return false;
+    }
+    uint32_t blockCount;
+    parseHeader(reinterpret_cast<const uint8_t*>(head), info, blockCount);
+
+    if (info.indexOffset == 0) {
+        if (!scanBlocks(in, base, CONTAINER_HEADER_SIZE, info)) return false;
+
+        // Writers that could not seek back still put the index right after the end block
+        ContainerInfo scanned = info;
+        info.indexOffset = static_cast<uint64_t>(in.tellg() - base);
+        if (!readIndex(in, base, static_cast<uint32_t>(scanned.blocks.size()), info)) {
+            info = scanned;
+            info.flags &= static_cast<uint8_t>(~CONTAINER_FLAG_CHECKSUMS);
+        }
+        return true;
+    }
+    if (!readIndex(in, base, blockCount, info)) {
+        cerr << "Invalid block table, corrupted file!" << endl;
+        return false;
+    }
+    return true;
+}
+
+bool readContainerIndex(int fd, ContainerInfo& info, uint64_t& fileSize) {
+    // Step 1: Header
+    uint8_t head[CONTAINER_HEADER_SIZE];
+    struct stat st;
+    if (fstat(fd, &st) != 0 || pread(fd, head, sizeof(head), 0) != static_cast<ssize_t>(sizeof(head))) return false;
+    fileSize = static_cast<uint64_t>(st.st_size);
+    int version = containerVersion(reinterpret_cast<const char*>(head), sizeof(head));
+    if (version < 1 || version > CONTAINER_VERSION) return false;
+
+    info = ContainerInfo();
+    info.version = static_cast<uint16_t>(version);
+    info.checksum = 0;
+    uint32_t blockCount;
+    parseHeader(head, info, blockCount);
+    if (info.indexOffset < CONTAINER_HEADER_SIZE || info.indexOffset >= fileSize) return false;
+
+    // Step 2: Index, up to the end of the file
+    string index(static_cast<size_t>(fileSize - info.indexOffset), '\0');
+    size_t done = 0;
+    while (done < index.size()) {
+        ssize_t n = pread(fd, &index[done], index.size() - done, static_cast<off_t>(info.indexOffset + done));
+        if (n <= 0) return false;
+        done += static_cast<size_t>(n);
+    }
+    return parseIndex(reinterpret_cast<const uint8_t*>(index.data()), index.size(), blockCount, info);
+}
+
+
+bool readBlock(istream& in, streamoff base, const BlockEntry& entry, BlockHeader& header, vector<uint8_t>& payload) {
+    in.clear();
+    in.seekg(base + static_cast<streamoff>(entry.offset));
+    if (!readBlockHeader(in, header) || header.codec != entry.codec || header.rawSize != entry.rawSize ||
+        header.payloadSize != entry.payloadSize) {
+        cerr << "Block header does not match the block table, corrupted file!" << endl;
+        return false;
+    }
+
+    payload.resize(header.payloadSize);
+    if (header.payloadSize > 0 && !in.read(reinterpret_cast<char*>(payload.data()), header.payloadSize)) {
+        cerr << "Truncated block, corrupted file!" << endl;
+        return false;
+    }
+    return true;
+}
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Function to decode a single block :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+bool BlockDecoder::readTable(const uint8_t* data, size_t size) {
+    vector<uint8_t> lengths;
+    if (!readCodeLengths(data, size, 256, lengths) || !decoder.init(lengths)) {
+        cerr << "Invalid code table, corrupted file!" << endl;
+        return false;
+    }
+    haveTable = true;
+    return true;
+}
+
+bool BlockDecoder::loadTable(const BlockHeader& header, const uint8_t* payload, uint64_t blockStart) {
+    if (header.codec != BlockCodec::Huffman || !(header.flags & BLOCK_FLAG_TABLE)) return false;
+    size_t used = 0;
+    if (header.flags & BLOCK_FLAG_FAR) {
+        vector<FarMatch> farMatches;
+        if (!readFarMatches(payload, header.payloadSize, header.rawSize, blockStart, farMatches, used)) {
+            cerr << "Invalid far match list, corrupted file!" << endl;
+            return false;
+        }
+    }
+    return readTable(payload + used, header.payloadSize - used);
+}
+
+bool BlockDecoder::decode(const BlockHeader& header, const uint8_t* payload, uint64_t blockStart,
+                          istream* history, string& block, BlockChecksum* checksum) {
+    // Far matches come first, the block codec only sees the bytes around them
+    const uint8_t* data = payload;
+    size_t dataSize = header.payloadSize;
+    size_t rawSize = header.rawSize;
+    vector<FarMatch> farMatches;
+    if (header.flags & BLOCK_FLAG_FAR) {
+        size_t used = 0;
+        if (!history || !readFarMatches(data, dataSize, rawSize, blockStart, farMatches, used)) {
+            cerr << "Invalid far match list, corrupted file!" << endl;
+            return false;
+        }
+        data += used;
+        dataSize -= used;
+        for (const FarMatch& m : farMatches) rawSize -= m.length;
+    }
+
+    string& decoded = farMatches.empty() ? block : residual;
+    BlockChecksum* fused = farMatches.empty() ? checksum : nullptr;
+    decoded.clear();
+    switch (header.codec) {
+        case BlockCodec::Stored:
+            if (dataSize != rawSize) {
+                cerr << "Stored block size mismatch, corrupted file!" << endl;
+                return false;
+            }
+            decoded.assign(reinterpret_cast<const char*>(data), dataSize);
+            break;
+
+        case BlockCodec::Huffman: {
+            size_t offset = 0;
+            if (header.flags & BLOCK_FLAG_TABLE) {
+                if (!readTable(data, dataSize)) return false;
+                offset = BYTE_TABLE_SIZE;
+            }
+            if (!haveTable || !decodeBytes(data + offset, dataSize - offset, decoder, rawSize, decoded, fused)) {
+                cerr << "Invalid Huffman block, corrupted file!" << endl;
+                return false;
+            }
+            break;
+        }
+
+        case BlockCodec::Lz:
+            if (!decodeLzBlock(data, dataSize, rawSize, decoded, fused)) {
+                cerr << "Invalid LZ block, corrupted file!" << endl;
+                return false;
+            }
+            break;
+
+        case BlockCodec::Bwt:
+            if (!decodeBwtBlock(data, dataSize, rawSize, decoded)) {
+                cerr << "Invalid BWT block, corrupted file!" << endl;
+                return false;
+            }
+            break;
+
+        default:
+            cerr << "Unknown block codec " << static_cast<int>(header.codec) << ", corrupted file!" << endl;
+            return false;
+    }
+
+    if (!farMatches.empty() && !applyFarMatches(farMatches, *history, residual, header.rawSize, block)) {
+        cerr << "Far match source unavailable, corrupted file!" << endl;
+        return false;
+    }
+
+    // Whatever the decoder did not checksum on the way (stored, BWT and far match blocks)
+    if (checksum) checksum->update(reinterpret_cast<const uint8_t*>(block.data()), block.size());
+    return true;
+}
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Function to decode a whole container :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+bool decompress_txt_container(istream& in, ostream& out, istream* history) {
+    streamoff base = in.tellg();
+    ContainerInfo info;
+    if (!readContainerInfo(in, info)) return false;
+    bool verify = (info.flags & CONTAINER_FLAG_CHECKSUMS) != 0;
+    uint32_t streamChecksum = 0;
+
+    BlockDecoder decoder;
+    vector<uint8_t> payload;
+    string block;
+    BlockHeader header;
+    for (const BlockEntry& entry : info.blocks) {
+        if (!readBlock(in, base, entry, header, payload)) return false;
+
+        // Sources of far matches have to be on disk before history can read them
+        if (header.flags & BLOCK_FLAG_FAR) out.flush();
+        BlockChecksum checksum;
+        if (!decoder.decode(header, payload.data(), entry.rawOffset, history, block, verify ? &checksum : nullptr)) {
+            return false;
+        }
+        if (verify) {
+            if (checksum.value() != entry.checksum) {
+                cerr << "Checksum mismatch in block at " << entry.rawOffset << ", corrupted file!" << endl;
+                return false;
+            }
+            streamChecksum = crc32cCombine(streamChecksum, checksum.value(), block.size());
+        }
+        out.write(block.data(), block.size());
+    }
+
+    if (verify && streamChecksum != info.checksum) {
+        cerr << "Checksum mismatch over the whole file, corrupted file!" << endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,180 @@
+#ifndef TXT_CONTAINER_H
+#define TXT_CONTAINER_H
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Huffman_txt.h"
+#include "Checksum_txt.h"
+#include "Lines_txt.h"
+
+/*
+Container written by the block based txt codecs:
+    header                       CONTAINER_HEADER_SIZE bytes, see below
+    blocks                       u8 codec, u8 flags, u32 raw size, u32 payload size, payload
+    end block                    codec End, no payload
+    index                        u32 block count, then per block
+                                     u64 file offset, u32 raw size, u32 payload size, u8 codec, u8 flags, u32 checksum
+                                 u32 checksum of the whole original data
+                                 then tagged sections (u32 tag, u32 size, data), closed by tag 0
+
+Header:
+    "CPZF"                       magic
+    u16 version                  CONTAINER_VERSION of the writer, readers refuse newer ones
+    u8 codec                     engine the writer ran (every block still names its own codec)
+    u8 flags                     CONTAINER_FLAG_*
+    u64 original size
+    u32 block size               nominal uncompressed block size
+    u32 block count
+    u64 index offset             0 when the writer could not seek back, readers then scan the blocks
+                                 and find the index right after the end block
+
+The writer patches the header once the index is written, so tools such as info read the
+header and the index without touching the payload. All integers are little endian.
+Checksums are CRC-32C (see Checksum_txt.h), checked while each block is decoded.
+*/
+
+const uint16_t CONTAINER_VERSION = 1;
+const size_t CONTAINER_MAGIC_SIZE = 4;
+const size_t CONTAINER_HEADER_SIZE = 32;
+const size_t BLOCK_HEADER_SIZE = 10;
+const size_t INDEX_ENTRY_SIZE = 22;
+
+// The block table carries a checksum of every uncompressed block and of the whole data
+const uint8_t CONTAINER_FLAG_CHECKSUMS = 0x01;
+
+enum class BlockCodec : uint8_t {
+    End = 0,
+    Stored = 1,
+    Huffman = 2,
+    Lz = 3,
+    Bwt = 4,
+};
+
+// The block starts with a fresh order-0 code table, otherwise it reuses the previous one
+const uint8_t BLOCK_FLAG_TABLE = 0x01;
+// The payload starts with a list of far matches copied from earlier output (see Ldm_txt.h)
+const uint8_t BLOCK_FLAG_FAR = 0x02;
+
+struct BlockHeader {
+    BlockCodec codec;
+    uint8_t flags;
+    uint32_t rawSize;
+    uint32_t payloadSize;
+};
+
+struct BlockEntry {
+    uint64_t offset;      // File offset of the block header
+    uint64_t rawOffset;   // Offset in the original data, derived from the raw sizes
+    uint32_t rawSize;
+    uint32_t payloadSize;
+    BlockCodec codec;
+    uint8_t flags;
+    uint32_t checksum;
+};
+
+struct ContainerInfo {
+    uint16_t version;
+    BlockCodec codec;
+    uint8_t flags;
+    uint64_t originalSize;
+    uint32_t blockSize;
+    uint64_t indexOffset;
+    uint32_t checksum;    // CRC-32C of the whole original data
+    std::vector<BlockEntry> blocks;
+    std::vector<std::pair<uint32_t, std::string>> sections;
+};
+
+void putU32(std::string& out, uint32_t v);
+void putU64(std::string& out, uint64_t v);
+uint32_t getU32(const uint8_t* p);
+uint64_t getU64(const uint8_t* p);
+
+bool isContainerMagic(const char* bytes, size_t size);
+
+// Format version of a file starting with bytes, -1 if it is no container
+int containerVersion(const char* bytes, size_t size);
+
+void writeBlock(std::ostream& out, const BlockHeader& header, const std::string& payload);
+bool readBlockHeader(std::istream& in, BlockHeader& header);
+
+// Streams blocks into a container and writes the index and header at the end
+class ContainerWriter {
+public:
+    ContainerWriter(std::ostream& out, BlockCodec codec, uint32_t blockSize);
+
+    // raw is the uncompressed block, only used for its checksum
+    void writeBlock(const BlockHeader& header, const std::string& payload, const uint8_t* raw, size_t rawSize);
+
+    // Extra index data for later readers (line index, file table, ...), written by finish()
+    void addSection(uint32_t tag, const std::string& data);
+
+    // Record the line index section (see Lines_txt.h), before the first block is written
+    void indexLines() { lineIndex = true; }
+
+    bool finish();
+
+    uint64_t bytesWritten() const { return written; }
+    uint64_t rawBytes() const { return originalSize; }
+
+private:
+    std::ostream& out;
+    std::streamoff start;
+    BlockCodec codec;
+    uint32_t blockSize;
+    uint64_t written;
+    uint64_t originalSize;
+    uint32_t checksum;
+    std::vector<BlockEntry> blocks;
+    std::vector<std::pair<uint32_t, std::string>> sections;
+    bool lineIndex;
+    LineCounter lineCounter;
+    std::vector<LineEntry> lines;
+
+    std::string header(uint64_t indexOffset) const;
+};
+
+// Read the header and block table of a container starting at the current position of in.
+// Files without an index offset get their table by scanning the block headers. Every error is
+// reported here except a missing magic, for which callers have their own message.
+bool readContainerInfo(std::istream& in, ContainerInfo& info);
+
+// Read the header and block table of the container file fd with two preads, without touching
+// the blocks. False on errors and for files without an index offset in the header (writers
+// that could not seek back), which only readContainerInfo can scan.
+bool readContainerIndex(int fd, ContainerInfo& info, uint64_t& fileSize);
+
+// Read the header and payload of a block listed in the table of the container starting at base
+bool readBlock(std::istream& in, std::streamoff base, const BlockEntry& entry, BlockHeader& header,
+               std::vector<uint8_t>& payload);
+
+// Decoder state carried from block to block (later Huffman blocks reuse earlier tables)
+class BlockDecoder {
+public:
+    BlockDecoder() : haveTable(false) {}
+
+    // Decode one block starting blockStart bytes into the original data. Far matches are
+    // read through history, which has to see every byte before blockStart. checksum, if
+    // given, receives the CRC-32C of the block, taken while the LZ and Huffman decoders run.
+    bool decode(const BlockHeader& header, const uint8_t* payload, uint64_t blockStart,
+                std::istream* history, std::string& block, BlockChecksum* checksum = nullptr);
+
+    // Take over the code table of a Huffman block without decoding it, so a later block
+    // that reuses the table can be decoded on its own
+    bool loadTable(const BlockHeader& header, const uint8_t* payload, uint64_t blockStart);
+
+private:
+    HuffmanDecoder decoder;
+    bool haveTable;
+    std::string residual;
+
+    bool readTable(const uint8_t* data, size_t size);
+};
+
+// Decode a whole container from the current position of in (magic included). Blocks with
+// far matches read their sources back through history, which has to see what out has written.
+bool decompress_txt_container(std::istream& in, std::ostream& out, std::istream* history = nullptr);
+
+#endif
@@ -1,9 +1,15 @@
+#include <algorithm>
+#include <cstdio>
 #include <iostream>
 #include <fstream>
 #include <unordered_map>
 #include <queue>
 #include <bitset>
 #include "Decompress_txt.h"
+#include "Container_txt.h"
+#include "Gzip_txt.h"
+#include "Seek_txt.h"
+#include "Extract_txt.h"
 
 using namespace std;
 
@@ -81,35 +87,87 @@ Node* loadTree(ifstream& inFile) {
 }
 
 
+// Blocks with far matches (--long) read earlier output back, the others decode in any order
+static bool independentBlocks(const ContainerInfo& info) {
+    for (const BlockEntry& entry : info.blocks) {
+        if (entry.flags & BLOCK_FLAG_FAR) return false;
+    }
+    return true;
+}
+
+// A failed decode leaves no output behind, a partly written file would pass for a result
+static bool keepOutput(bool ok, const string& outputFile) {
+    if (!ok) remove(outputFile.c_str());
+    return ok;
+}
+
+
 /*
 ------------------------------------------------------------------------------------------------------------------------------------
 Function to decode bitstream using Huffman tree
 ------------------------------------------------------------------------------------------------------------------------------------
 */
 
-void decompress_txt_file(const string& compressedFile, const string& outputFile) {
+static bool decodeFile(const string& compressedFile, const string& outputFile) {
     ifstream inFile(compressedFile, ios::binary);
     ofstream outFile(outputFile);
 
     if (!inFile.is_open() || !outFile.is_open()) {
         cerr << "Error opening input/output files." << endl;
-        return;
+        return false;
+    }
+
+    // Containers carry a magic, files from older releases start straight with the tree (read only)
+    char magic[CONTAINER_MAGIC_SIZE];
+    bool haveMagic = static_cast<bool>(inFile.read(magic, CONTAINER_MAGIC_SIZE));
+    if (haveMagic && isGzipMagic(magic, CONTAINER_MAGIC_SIZE)) {
+        inFile.seekg(0);
+        if (!decompress_txt_gzip(inFile, outFile)) return false;
+        cout << "Decompression complete. Output written to " << outputFile << endl;
+        return true;
     }
+    if (haveMagic && isContainerMagic(magic, CONTAINER_MAGIC_SIZE)) {
+        inFile.seekg(0);
+        ContainerInfo info;
+        if (!readContainerInfo(inFile, info)) return false;
+        inFile.clear();
+        inFile.seekg(0);
+
+        // Blocks without far matches decode on their own, so they go in parallel straight into the output file
+        if (independentBlocks(info)) {
+            outFile.close();
+            ExtractTarget target = {outputFile, 0, info.originalSize};
+            if (!extract_txt_blocks(compressedFile, vector<ExtractTarget>(1, target))) return false;
+            cout << "Decompression complete. Output written to " << outputFile << endl;
+            return true;
+        }
+
+        // Far matches are copied from what has already been written
+        ifstream history(outputFile, ios::binary);
+        if (!decompress_txt_container(inFile, outFile, &history)) return false;
+        cout << "Decompression complete. Output written to " << outputFile << endl;
+        return true;
+    }
+    inFile.clear();
+    inFile.seekg(0);
 
     // Step 1: Rebuild the Huffman Tree
     Node* root = loadTree(inFile);
 
     // Step 2: Read until '#' (end of tree marker)
-    char marker;
+    char marker = 0;
     inFile.get(marker);
-    if (marker != '#') {
+    if (!root || marker != '#') {
         cerr << "Tree marker not found, corrupted file!" << endl;
-        return;
+        return false;
     }
 
     // Step 3: Read actual number of bits
     int totalBits = 0;
-    inFile.read(reinterpret_cast<char*>(&totalBits), sizeof(int));
+    if (!inFile.read(reinterpret_cast<char*>(&totalBits), sizeof(int))) {
+        cerr << "Bit count not found, corrupted file!" << endl;
+        return false;
+    }
 
     // Step 4: Now decode only 'totalBits' from the stream
     Node* curr = root;
@@ -119,6 +177,10 @@ void decompress_txt_file(const string& compressedFile, const string& outputFile)
         bitset<8> bits(byte);
         for (int i = 7; i >= 0 && bitsRead < totalBits; --i, ++bitsRead) {
             curr = bits[i] ? curr->r : curr->l;
+            if (!curr) {
+                cerr << "Invalid Huffman code, corrupted file!" << endl;
+                return false;
+            }
             if (!curr->l && !curr->r) {
                 outFile.put(curr->character);
                 curr = root;
@@ -126,12 +188,113 @@ void decompress_txt_file(const string& compressedFile, const string& outputFile)
         }
     }
 
+    if (bitsRead < totalBits) {
+        cerr << "Encoded data is truncated, corrupted file!" << endl;
+        return false;
+    }
+
     inFile.close();
     outFile.close();
     cout << "Decompression complete. Output written to " << outputFile << endl;
+    return true;
+}
+
+bool decompress_txt_file(const string& compressedFile, const string& outputFile) {
+    return keepOutput(decodeFile(compressedFile, outputFile), outputFile);
+}
+
+
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Function to decode a byte range through the block table
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+static bool decodeRange(const string& compressedFile, const string& outputFile, uint64_t offset, uint64_t length) {
+    ifstream inFile(compressedFile, ios::binary);
+    ofstream outFile(outputFile, ios::binary);
+
+    if (!inFile.is_open() || !outFile.is_open()) {
+        cerr << "Error opening input/output files." << endl;
+        return false;
+    }
+
+    ContainerReader reader(inFile);
+    if (!reader.open()) {
+        cerr << "Random access needs a file written by this version (older releases wrote no block table)." << endl;
+        return false;
+    }
+
+    // The range is cut at the end of the data
+    uint64_t originalSize = reader.info().originalSize;
+    if (offset > originalSize) {
+        cerr << "Offset " << offset << " is past the end of the data (" << originalSize << " bytes)." << endl;
+        return false;
+    }
+    length = min(length, originalSize - offset);
+
+    if (!reader.read(offset, length, outFile)) return false;
+    cout << "Decoded " << length << " bytes at offset " << offset << " with " << reader.blocksDecoded()
+         << " block decode(s), the file has " << reader.info().blocks.size() << " blocks. Output written to "
+         << outputFile << endl;
+    return true;
 }
 
+bool decompress_txt_range(const string& compressedFile, const string& outputFile, uint64_t offset, uint64_t length) {
+    return keepOutput(decodeRange(compressedFile, outputFile, offset, length), outputFile);
+}
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Function to decode a range of lines through the line index
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+static bool decodeLines(const string& compressedFile, const string& outputFile, uint64_t first, uint64_t last) {
+    ifstream inFile(compressedFile, ios::binary);
+    ofstream outFile(outputFile, ios::binary);
+
+    if (!inFile.is_open() || !outFile.is_open()) {
+        cerr << "Error opening input/output files." << endl;
+        return false;
+    }
 
+    ContainerReader reader(inFile);
+    if (!reader.open()) {
+        cerr << "Line access needs a file written by this version (older releases wrote no block table)." << endl;
+        return false;
+    }
+    if (!reader.hasLineIndex()) {
+        cout << "No line index (compress with --line-index), counting the lines of every block." << endl;
+    }
+
+    // Step 1: Where the first line starts and where the line after the last one starts
+    uint64_t start, end;
+    if (first == 0 || last < first) {
+        cerr << "Lines are numbered from 1 and the last line cannot come before the first." << endl;
+        return false;
+    }
+    if (!reader.lineStart(first, start)) {
+        uint64_t count = 0;
+        if (reader.lineCount(count)) cerr << "Line " << first << " is past the end of the data (" << count << " lines)." << endl;
+        return false;
+    }
+    if (last == UINT64_MAX || !reader.lineStart(last + 1, end)) end = reader.info().originalSize;
+
+    // Step 2: Only the blocks between the two
+    if (!reader.read(start, end - start, outFile)) return false;
+    cout << "Decoded lines " << first << " to " << last << " (" << end - start << " bytes) with "
+         << reader.blocksDecoded() << " block decode(s), the file has " << reader.info().blocks.size()
+         << " blocks. Output written to " << outputFile << endl;
+    return true;
+}
+
+bool decompress_txt_lines(const string& compressedFile, const string& outputFile, uint64_t first, uint64_t last) {
+    return keepOutput(decodeLines(compressedFile, outputFile, first, last), outputFile);
+}
 
 /*
 ------------------------------------------------------------------------------------------------------------------------------------
@@ -1,8 +1,21 @@
 #ifndef TXT_DECOMPRESSOR_H
 #define TXT_DECOMPRESSOR_H
 
+#include <cstdint>
 #include <string>
 
-void decompress_txt_file(const std::string& compressedFile, const std::string& outputFile);
+// The decoders below return false on errors, corrupted files included, and then remove the
+// output file instead of leaving a partly written one behind
+bool decompress_txt_file(const std::string& compressedFile, const std::string& outputFile);
+
+// Decode only bytes [offset, offset + length) of the original data, reading just the blocks
+// that cover them. Needs a block based file, which older releases did not write.
+bool decompress_txt_range(const std::string& compressedFile, const std::string& outputFile,
+                          uint64_t offset, uint64_t length);
+
+// Decode only lines first to last (1-based, inclusive) through the line index of the file.
+// Files compressed without --line-index work too, their lines are counted block by block first.
+bool decompress_txt_lines(const std::string& compressedFile, const std::string& outputFile,
+                          uint64_t first, uint64_t last);
 
 #endif
@@ -0,0 +1,98 @@
+#include <algorithm>
+#include <cstring>
+#include "Dedup_txt.h"
+#include "Checksum_txt.h"
+
+using namespace std;
+
+
+// Cut points are tested on the top bits of the gear hash, which depend on the last 64 bytes
+// (the low bits only on the last few). 15 bits cut once in 32 KB on average, 11 bits once in 2 KB.
+static const uint64_t MASK_SMALL = ~static_cast<uint64_t>(0) << (64 - 15);
+static const uint64_t MASK_LARGE = ~static_cast<uint64_t>(0) << (64 - 11);
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Chunking :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+size_t nextChunk(const uint8_t* data, size_t size) {
+    if (size <= DEDUP_MIN_CHUNK) return size;
+    const uint64_t* gear = gearTable();
+    size_t normal = min(size, DEDUP_AVG_CHUNK);
+    size_t end = min(size, DEDUP_MAX_CHUNK);
+
+    // The first DEDUP_MIN_CHUNK bytes can never hold a cut, so they are not hashed at all
+    uint64_t hash = 0;
+    size_t i = DEDUP_MIN_CHUNK;
+    for (; i < normal; ++i) {
+        hash = (hash << 1) + gear[data[i]];
+        if (!(hash & MASK_SMALL)) return i + 1;
+    }
+    for (; i < end; ++i) {
+        hash = (hash << 1) + gear[data[i]];
+        if (!(hash & MASK_LARGE)) return i + 1;
+    }
+    return end;
+}
+
+// 64-bit multiply and fold over 8 byte words, independent of the CRC next to it in the fingerprint
+static uint64_t chunkHash(const uint8_t* data, size_t size) {
+    uint64_t hash = 0x9E3779B97F4A7C15ull ^ size;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, 8);
+        hash = (hash ^ word) * 0xFF51AFD7ED558CCDull;
+        hash ^= hash >> 32;
+    }
+    for (; i < size; ++i) hash = (hash ^ data[i]) * 0x100000001B3ull;
+    return hash ^ (hash >> 29);
+}
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Duplicate search :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+bool ChunkDeduplicator::sameBytes(uint64_t source, const uint8_t* data, size_t size) {
+    buffer.resize(size);
+    history.clear();
+    history.seekg(static_cast<streamoff>(source));
+    history.read(&buffer[0], size);
+    return static_cast<size_t>(history.gcount()) == size && memcmp(buffer.data(), data, size) == 0;
+}
+
+void ChunkDeduplicator::process(const uint8_t* data, size_t size, uint64_t blockStart, vector<FarMatch>& matches) {
+    matches.clear();
+
+    // Chunks of this block only become visible to later blocks, far matches cannot copy from their own block
+    vector<pair<Fingerprint, uint64_t>> pending;
+    for (size_t pos = 0; pos < size;) {
+        size_t length = nextChunk(data + pos, size - pos);
+        Fingerprint fingerprint = {chunkHash(data + pos, length), crc32cUpdate(0, data + pos, length),
+                                   static_cast<uint32_t>(length)};
+
+        unordered_map<Fingerprint, uint64_t, FingerprintHash>::const_iterator seen = chunks.find(fingerprint);
+        if (seen == chunks.end()) {
+            pending.push_back(make_pair(fingerprint, blockStart + pos));
+        } else if (length >= LDM_MIN_MATCH && sameBytes(seen->second, data + pos, length)) {
+            // Runs of repeated chunks that were also adjacent before become one match
+            FarMatch* last = matches.empty() ? nullptr : &matches.back();
+            if (last && last->offset + last->length == pos && last->source + last->length == seen->second) {
+                last->length += static_cast<uint32_t>(length);
+            } else {
+                FarMatch match = {static_cast<uint32_t>(pos), static_cast<uint32_t>(length), seen->second};
+                matches.push_back(match);
+            }
+            duplicates += length;
+        }
+        pos += length;
+    }
+
+    // The first position of a chunk is kept, later copies point there as well
+    for (const pair<Fingerprint, uint64_t>& p : pending) chunks.insert(p);
+}
@@ -0,0 +1,72 @@
+#ifndef TXT_DEDUP_H
+#define TXT_DEDUP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Ldm_txt.h"
+
+/*
+Content defined chunking deduplication (FastCDC style). A gear rolling hash cuts every block
+into chunks where the hash matches a mask, so an insertion only moves the cuts next to it and
+identical content yields identical chunks wherever it sits. Chunks are at least DEDUP_MIN_CHUNK
+and at most DEDUP_MAX_CHUNK bytes; below DEDUP_AVG_CHUNK a mask with more bits makes cuts rare,
+above it one with fewer bits makes them likely (normalized chunking), which keeps the sizes
+close to the average.
+
+Every chunk is fingerprinted (length, CRC-32C and a 64-bit multiplicative hash). A chunk seen in
+an earlier block becomes a far match on its first copy (see Ldm_txt.h), so the block codec only
+compresses what is new and the decoder copies the rest back from the output. The first copy is
+read back and compared byte for byte before the match is made, so a fingerprint collision costs
+a missed match, never an archive that cannot be restored.
+*/
+
+const size_t DEDUP_MIN_CHUNK = 2 * 1024;
+const size_t DEDUP_AVG_CHUNK = 8 * 1024;
+const size_t DEDUP_MAX_CHUNK = 64 * 1024;
+
+class ChunkDeduplicator {
+public:
+    // history reads the data seen so far, like the one of LongDistanceMatcher
+    explicit ChunkDeduplicator(std::istream& history) : history(history), duplicates(0) {}
+
+    // Far matches for the chunks of the block at blockStart that appeared in earlier blocks,
+    // then remember its chunks for later ones. Blocks have to be passed in order.
+    void process(const uint8_t* data, size_t size, uint64_t blockStart, std::vector<FarMatch>& matches);
+
+    // Bytes replaced by far matches so far
+    uint64_t duplicateBytes() const { return duplicates; }
+
+    size_t uniqueChunks() const { return chunks.size(); }
+
+private:
+    struct Fingerprint {
+        uint64_t hash;
+        uint32_t checksum;
+        uint32_t length;
+
+        bool operator==(const Fingerprint& other) const {
+            return hash == other.hash && checksum == other.checksum && length == other.length;
+        }
+    };
+
+    struct FingerprintHash {
+        size_t operator()(const Fingerprint& f) const { return static_cast<size_t>(f.hash); }
+    };
+
+    std::istream& history;
+    std::unordered_map<Fingerprint, uint64_t, FingerprintHash> chunks;   // First position of every chunk
+    uint64_t duplicates;
+    std::string buffer;
+
+    // The bytes at source are data[0, size)
+    bool sameBytes(uint64_t source, const uint8_t* data, size_t size);
+};
+
+// Length of the first chunk of data[0, size)
+size_t nextChunk(const uint8_t* data, size_t size);
+
+#endif
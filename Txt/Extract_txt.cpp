@@ -0,0 +1,201 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <fcntl.h>
+#include <unistd.h>
+#include "Extract_txt.h"
+#include "Seek_txt.h"
+#include "../Thread_Pool/ThreadPool.h"
+
+using namespace std;
+
+
+// Blocks that far matches copy from stay decoded for the next blocks pointing there
+static const size_t EXTRACT_CACHE_BLOCKS = 8;
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Output files :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+// Create the file at its final size and return its descriptor (-1 on failure), the workers only fill it in
+static int preallocate(const string& path, uint64_t size) {
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        cerr << "Cannot create " << path << ": " << strerror(errno) << endl;
+        return -1;
+    }
+    bool ok = true;
+    if (size > 0) {
+#ifdef __linux__
+        // Reserves the extents without writing zeros, file systems without it just get the size
+        ok = fallocate(fd, 0, 0, static_cast<off_t>(size)) == 0 || ftruncate(fd, static_cast<off_t>(size)) == 0;
+#else
+        ok = ftruncate(fd, static_cast<off_t>(size)) == 0;
+#endif
+    }
+    if (!ok) {
+        cerr << "Cannot allocate " << size << " bytes for " << path << ": " << strerror(errno) << endl;
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+namespace {
+
+// The descriptors of the targets, open from preallocation until every block is written. pwrite
+// does not move the file offset, so the workers share them.
+struct OutputFiles {
+    vector<int> fds;
+
+    ~OutputFiles() {
+        for (int fd : fds) ::close(fd);
+    }
+
+    // Close every file, reporting the write errors close can still return
+    bool close(const vector<ExtractTarget>& targets) {
+        bool ok = true;
+        for (size_t i = 0; i < fds.size(); ++i) {
+            if (::close(fds[i]) != 0) {
+                cerr << "Error writing " << targets[i].path << ": " << strerror(errno) << endl;
+                ok = false;
+            }
+        }
+        fds.clear();
+        return ok;
+    }
+};
+
+} // namespace
+
+static bool writeAt(int fd, const char* data, size_t size, uint64_t offset) {
+    while (size > 0) {
+        ssize_t n = pwrite(fd, data, size, static_cast<off_t>(offset));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+// Decode block index and write it into the targets it overlaps, fds are the open targets
+static bool writeBlock(ContainerReader& reader, size_t index, const vector<ExtractTarget>& targets,
+                       const vector<int>& fds) {
+    const string* block = reader.block(index);
+    if (!block) return false;
+    uint64_t start = reader.info().blocks[index].rawOffset;
+    uint64_t end = start + block->size();
+
+    vector<ExtractTarget>::const_iterator it = upper_bound(
+        targets.begin(), targets.end(), start,
+        [](uint64_t value, const ExtractTarget& target) { return value < target.offset + target.size; });
+    for (; it != targets.end() && it->offset < end; ++it) {
+        if (it->size == 0) continue;
+        uint64_t from = max(start, it->offset);
+        uint64_t to = min(end, it->offset + it->size);
+        int fd = fds[static_cast<size_t>(it - targets.begin())];
+        if (!writeAt(fd, block->data() + (from - start), static_cast<size_t>(to - from), from - it->offset)) {
+            cerr << "Error writing " << it->path << ": " << strerror(errno) << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Parallel decode :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+namespace {
+
+// A reader is not thread safe, so every running task borrows one
+struct ReaderSlot {
+    ifstream file;
+    ContainerReader reader;
+
+    explicit ReaderSlot(const string& path) : file(path, ios::binary), reader(file, EXTRACT_CACHE_BLOCKS) {}
+};
+
+} // namespace
+
+bool extract_txt_blocks(const string& compressedFile, const vector<ExtractTarget>& targets, unsigned threads) {
+    // Step 1: One reader per worker
+    ThreadPool pool(threads);
+    vector<unique_ptr<ReaderSlot>> slots;
+    vector<ReaderSlot*> idle;
+    for (unsigned i = 0; i < pool.size(); ++i) {
+        slots.emplace_back(new ReaderSlot(compressedFile));
+        if (!slots.back()->file.is_open() || !slots.back()->reader.open()) {
+            cerr << "Error opening " << compressedFile << endl;
+            return false;
+        }
+        idle.push_back(slots.back().get());
+    }
+    const ContainerInfo& info = slots[0]->reader.info();
+
+    uint64_t covered = 0;
+    bool ordered = true;
+    for (const ExtractTarget& target : targets) {
+        ordered = ordered && target.offset >= covered && target.size <= info.originalSize - target.offset;
+        if (!ordered) break;
+        covered = target.offset + target.size;
+    }
+    if (!ordered) {
+        cerr << "The output files do not fit the data, corrupted file!" << endl;
+        return false;
+    }
+
+    // Step 2: The whole data checksum follows from the block checksums, each block is checked as it decodes
+    if (info.flags & CONTAINER_FLAG_CHECKSUMS) {
+        uint32_t checksum = 0;
+        for (const BlockEntry& entry : info.blocks) checksum = crc32cCombine(checksum, entry.checksum, entry.rawSize);
+        if (checksum != info.checksum) {
+            cerr << "Checksum mismatch over the whole file, corrupted file!" << endl;
+            return false;
+        }
+    }
+
+    // Step 3: Output files at their final size, each opened once for all the blocks
+    OutputFiles outputs;
+    for (const ExtractTarget& target : targets) {
+        int fd = preallocate(target.path, target.size);
+        if (fd < 0) return false;
+        outputs.fds.push_back(fd);
+    }
+
+    // Step 4: Blocks decode in any order, each straight into its place
+    atomic<bool> failed(false);
+    mutex lock;
+    for (size_t i = 0; i < info.blocks.size(); ++i) {
+        pool.submit([&, i]() {
+            if (failed) return;
+            ReaderSlot* slot;
+            {
+                lock_guard<mutex> guard(lock);
+                slot = idle.back();
+                idle.pop_back();
+            }
+            bool ok = writeBlock(slot->reader, i, targets, outputs.fds);
+            {
+                lock_guard<mutex> guard(lock);
+                idle.push_back(slot);
+            }
+            if (!ok) failed = true;
+        });
+    }
+    pool.wait();
+    return outputs.close(targets) && !failed;
+}
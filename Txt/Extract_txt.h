@@ -0,0 +1,29 @@
+#ifndef TXT_EXTRACT_H
+#define TXT_EXTRACT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+Parallel extraction of block based containers. The output files are created and preallocated
+to their final size first (fallocate on Linux, ftruncate elsewhere), then the blocks are decoded
+on the thread pool in any order and each worker writes its bytes with pwrite at their final
+offsets, so no block waits for the ones before it and no file is written through a stream.
+Each file is opened once and its descriptor shared by the workers until the pool drains.
+Every worker reads the container through its own handle and reader (see Seek_txt.h).
+*/
+
+// A file covering [offset, offset + size) of the original data
+struct ExtractTarget {
+    std::string path;
+    uint64_t offset;
+    uint64_t size;
+};
+
+// targets are in data order, do not overlap and lie within the original data; bytes outside
+// them are decoded (and checked) but not written. threads 0 uses every core.
+bool extract_txt_blocks(const std::string& compressedFile, const std::vector<ExtractTarget>& targets,
+                        unsigned threads = 0);
+
+#endif
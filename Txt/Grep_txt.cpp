@@ -0,0 +1,236 @@
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Grep_txt.h"
+#include "Seek_txt.h"
+
+using namespace std;
+
+
+static const size_t ANCHOR_SAMPLE = 64 * 1024;
+// Blocks are searched once, the cache only helps blocks that far matches point into
+static const size_t GREP_CACHE_BLOCKS = 2;
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Search kernel :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+// Candidates are found with memchr, which compares 16-32 bytes per instruction, on the pattern
+// byte that is rarest in the data. Each candidate is then checked with memcmp.
+namespace {
+
+class Finder {
+public:
+    explicit Finder(const string& pattern) : pattern(pattern), anchor(0) {}
+
+    // Pick the anchor byte from the byte counts of the start of data
+    void adapt(const char* data, size_t size) {
+        size_t counts[256] = {0};
+        for (size_t i = 0, n = min(size, ANCHOR_SAMPLE); i < n; ++i) counts[static_cast<uint8_t>(data[i])]++;
+        anchor = 0;
+        for (size_t k = 1; k < pattern.size(); ++k) {
+            if (counts[static_cast<uint8_t>(pattern[k])] < counts[static_cast<uint8_t>(pattern[anchor])]) anchor = k;
+        }
+    }
+
+    const char* find(const char* p, const char* end) const {
+        size_t m = pattern.size();
+        if (static_cast<size_t>(end - p) < m) return nullptr;
+        const char* q = p + anchor;
+        const char* last = end - m + anchor;
+        while (q <= last) {
+            const char* hit = static_cast<const char*>(memchr(q, pattern[anchor], static_cast<size_t>(last - q) + 1));
+            if (!hit) return nullptr;
+            if (memcmp(hit - anchor, pattern.data(), m) == 0) return hit - anchor;
+            q = hit + 1;
+        }
+        return nullptr;
+    }
+
+private:
+    const string& pattern;
+    size_t anchor;
+};
+
+struct LineMatch {
+    uint64_t newlines;   // '\n' before the line in its block
+    string line;
+};
+
+// What one block contributes: matches of the lines that lie completely inside it, and the
+// pieces before its first and after its last '\n' for the lines crossing its borders
+struct BlockResult {
+    bool ok;
+    bool hasNewline;
+    uint64_t newlines;
+    string head;         // The whole block when it has no '\n'
+    string tail;
+    vector<LineMatch> matches;
+};
+
+} // namespace
+
+// Lines of data[begin, end) that contain the pattern. begin follows the first '\n' of the block
+static void searchLines(const char* data, size_t begin, size_t end, const Finder& finder, vector<LineMatch>& matches) {
+    const char* counted = data + begin;
+    uint64_t newlines = 1;
+    const char* p = data + begin;
+    const char* stop = data + end;
+    while (const char* hit = finder.find(p, stop)) {
+        const char* lineStart = hit;
+        while (lineStart > p && lineStart[-1] != '\n') --lineStart;
+        const char* lineEnd = static_cast<const char*>(memchr(hit, '\n', static_cast<size_t>(stop - hit)));
+        if (!lineEnd) lineEnd = stop;
+
+        newlines += static_cast<uint64_t>(count(counted, lineStart, '\n'));
+        counted = lineStart;
+        LineMatch match = {newlines, string(lineStart, lineEnd)};
+        matches.push_back(match);
+        if (lineEnd == stop) break;
+        p = lineEnd + 1;
+    }
+}
+
+static void searchBlock(const string& block, const string& pattern, BlockResult& result) {
+    const char* data = block.data();
+    const char* first = static_cast<const char*>(memchr(data, '\n', block.size()));
+    result.ok = true;
+    result.hasNewline = first != nullptr;
+    if (!first) {
+        result.newlines = 0;
+        result.head = block;
+        return;
+    }
+
+    size_t last = block.size() - 1;
+    while (block[last] != '\n') --last;
+    result.newlines = static_cast<uint64_t>(count(first, data + last + 1, '\n'));
+    result.head.assign(data, first);
+    result.tail.assign(block, last + 1, string::npos);
+
+    Finder finder(pattern);
+    finder.adapt(data, block.size());
+    size_t begin = static_cast<size_t>(first - data) + 1;
+    searchLines(data, begin, last + 1, finder, result.matches);
+}
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Parallel search :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+bool grep_txt(const string& compressedFile, const string& pattern, ostream& out, uint64_t& matches, unsigned threads) {
+    matches = 0;
+    if (pattern.empty() || pattern.find('\n') != string::npos) {
+        cerr << "The pattern has to be a non empty string without line breaks." << endl;
+        return false;
+    }
+
+    // Step 1: One reader per worker, each with its own file handle and block cache
+    if (threads == 0) threads = max(1u, thread::hardware_concurrency());
+    vector<unique_ptr<ifstream>> files;
+    vector<unique_ptr<ContainerReader>> readers;
+    for (unsigned t = 0; t < threads; ++t) {
+        files.emplace_back(new ifstream(compressedFile, ios::binary));
+        readers.emplace_back(new ContainerReader(*files.back(), GREP_CACHE_BLOCKS));
+        if (!files.back()->is_open() || !readers.back()->open()) {
+            cerr << "grep needs a file written by this version (older releases wrote no block table)." << endl;
+            return false;
+        }
+        if (t + 1 >= readers[0]->info().blocks.size()) break;
+    }
+    size_t blockCount = readers[0]->info().blocks.size();
+
+    // Step 2: Workers take the next block, decode it into memory and search it
+    vector<BlockResult> results(blockCount);
+    vector<bool> done(blockCount, false);
+    atomic<size_t> next(0);
+    atomic<bool> failed(false);
+    mutex lock;
+    condition_variable ready;
+
+    vector<thread> workers;
+    for (size_t t = 0; t < readers.size(); ++t) {
+        workers.emplace_back([&, t]() {
+            size_t index;
+            while (!failed && (index = next++) < blockCount) {
+                BlockResult result;
+                const string* block = readers[t]->block(index);
+                if (block) {
+                    searchBlock(*block, pattern, result);
+                } else {
+                    result.ok = false;
+                    failed = true;
+                }
+                lock_guard<mutex> guard(lock);
+                results[index] = move(result);
+                done[index] = true;
+                ready.notify_all();
+            }
+        });
+    }
+
+    // Step 3: Results in block order, joining the lines that cross block borders
+    Finder finder(pattern);
+    string carry;
+    uint64_t carryLine = 1, newlinesBefore = 0;
+    bool ok = true;
+    for (size_t i = 0; i < blockCount; ++i) {
+        BlockResult result;
+        {
+            unique_lock<mutex> guard(lock);
+            ready.wait(guard, [&]() { return done[i]; });
+            result = move(results[i]);
+        }
+        if (!result.ok) {
+            ok = false;
+            break;
+        }
+
+        carry += result.head;
+        if (!result.hasNewline) continue;
+        if (finder.find(carry.data(), carry.data() + carry.size())) {
+            out << carryLine << ':' << carry << '\n';
+            ++matches;
+        }
+        for (const LineMatch& m : result.matches) {
+            out << 1 + newlinesBefore + m.newlines << ':' << m.line << '\n';
+            ++matches;
+        }
+        newlinesBefore += result.newlines;
+        carry.swap(result.tail);
+        carryLine = 1 + newlinesBefore;
+    }
+    if (ok && !carry.empty() && finder.find(carry.data(), carry.data() + carry.size())) {
+        out << carryLine << ':' << carry << '\n';
+        ++matches;
+    }
+
+    failed = failed || !ok;
+    for (thread& worker : workers) worker.join();
+    return ok;
+}
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Export Function :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+bool grep_txt_file(const string& compressedFile, const string& pattern) {
+    uint64_t matches = 0;
+    if (!grep_txt(compressedFile, pattern, cout, matches)) return false;
+    cout << matches << " matching line(s)" << endl;
+    return true;
+}
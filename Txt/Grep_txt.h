@@ -0,0 +1,23 @@
+#ifndef TXT_GREP_H
+#define TXT_GREP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+/*
+Substring search over block based containers without writing the decompressed data anywhere.
+Worker threads decode whole blocks into memory and search them right away. Lines that cross a
+block boundary are put together from the pieces on both sides once the blocks are in, so
+matches come out in file order with their line numbers (as grep -nF).
+*/
+
+// Write the lines containing pattern to out as "line number:line". threads 0 uses every core.
+bool grep_txt(const std::string& compressedFile, const std::string& pattern, std::ostream& out,
+              uint64_t& matches, unsigned threads = 0);
+
+// Print the matches and their count, false if the file cannot be read or a block fails its checksum
+bool grep_txt_file(const std::string& compressedFile, const std::string& pattern);
+
+#endif
@@ -0,0 +1,602 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include "Gzip_txt.h"
+#include "Checksum_txt.h"
+#include "Container_txt.h"
+#include "Huffman_txt.h"
+#include "Levels_txt.h"
+#include "Lz_txt.h"
+
+using namespace std;
+
+
+static const uint32_t DEFLATE_WINDOW = 32768;
+static const uint32_t DEFLATE_MIN_MATCH = 3;
+static const uint32_t DEFLATE_MAX_MATCH = 258;
+static const int DEFLATE_MAX_BITS = 15;
+static const int CODE_LENGTH_MAX_BITS = 7;
+
+static const int LITLEN_SYMBOLS = 286;
+static const int DISTANCE_SYMBOLS = 30;
+static const int CODE_LENGTH_SYMBOLS = 19;
+static const int END_OF_BLOCK = 256;
+
+static const size_t GZIP_CHUNK = 1 << 20;         // Input parsed at once, matches stay inside it
+static const size_t BLOCK_TOKENS = 32768;         // Literals and matches per DEFLATE block
+static const size_t STORED_MAX = 65535;
+static const size_t INFLATE_FLUSH = 1 << 20;      // Output buffered before it is written out
+static const int DEFAULT_GZIP_LEVEL = 6;
+
+static const uint16_t LENGTH_BASE[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t LENGTH_EXTRA[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const uint16_t DISTANCE_BASE[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const uint8_t DISTANCE_EXTRA[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+// Order in which the code length code lengths are sent
+static const uint8_t CODE_LENGTH_ORDER[CODE_LENGTH_SYMBOLS] = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+static const uint8_t GZIP_ID1 = 0x1F;
+static const uint8_t GZIP_ID2 = 0x8B;
+static const uint8_t GZIP_DEFLATE = 8;
+static const uint8_t GZIP_OS_UNIX = 3;
+static const uint8_t FLAG_HCRC = 0x02;
+static const uint8_t FLAG_EXTRA = 0x04;
+static const uint8_t FLAG_NAME = 0x08;
+static const uint8_t FLAG_COMMENT = 0x10;
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Lookup tables :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+namespace {
+
+struct DeflateTables {
+    uint8_t lengthCode[DEFLATE_MAX_MATCH + 1];   // match length -> index into LENGTH_BASE
+    uint8_t distanceCode[512];                   // distances up to 256 direct, beyond that by dist >> 7
+
+    DeflateTables() {
+        for (int code = 0; code < 29; ++code) {
+            int top = code == 28 ? 1 : 1 << LENGTH_EXTRA[code];
+            for (int k = 0; k < top; ++k) lengthCode[LENGTH_BASE[code] + k] = static_cast<uint8_t>(code);
+        }
+        for (int code = 0; code < 30; ++code) {
+            for (int k = 0; k < (1 << DISTANCE_EXTRA[code]); ++k) {
+                uint32_t d = DISTANCE_BASE[code] + k - 1;
+                if (d < 256) distanceCode[d] = static_cast<uint8_t>(code);
+                else distanceCode[256 + (d >> 7)] = static_cast<uint8_t>(code);
+            }
+        }
+    }
+};
+
+// A literal (length 0, value = byte) or a match (value = distance)
+struct DeflateToken {
+    uint16_t length;
+    uint16_t value;
+};
+
+} // namespace
+
+static const DeflateTables TABLES;
+
+static inline int distanceCode(uint32_t dist) {
+    uint32_t d = dist - 1;
+    return d < 256 ? TABLES.distanceCode[d] : TABLES.distanceCode[256 + (d >> 7)];
+}
+
+bool isGzipMagic(const char* bytes, size_t size) {
+    return size >= 2 && static_cast<uint8_t>(bytes[0]) == GZIP_ID1 && static_cast<uint8_t>(bytes[1]) == GZIP_ID2;
+}
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+DEFLATE block writer :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+namespace {
+
+// Everything a dynamic block header needs, plus the size of the whole block in bits
+struct DynamicBlock {
+    vector<uint8_t> litLengths, distLengths, clLengths;
+    vector<uint32_t> litCodes, distCodes, clCodes;
+    vector<pair<uint8_t, uint8_t>> clSymbols;   // code length symbol, extra bits value
+    int hlit, hdist, hclen;
+    uint64_t bits;
+};
+
+} // namespace
+
+static void tokenize(const uint8_t* data, const vector<LzSequence>& sequences, vector<DeflateToken>& tokens) {
+    tokens.clear();
+    size_t pos = 0;
+    for (const LzSequence& seq : sequences) {
+        for (uint32_t i = 0; i < seq.literals; ++i) {
+            DeflateToken lit = {0, data[pos + i]};
+            tokens.push_back(lit);
+        }
+        pos += seq.literals;
+
+        // Longer matches become several, none shorter than the minimum
+        uint32_t left = seq.length;
+        while (left) {
+            uint32_t take = left > DEFLATE_MAX_MATCH ? min(DEFLATE_MAX_MATCH, left - DEFLATE_MIN_MATCH) : left;
+            DeflateToken match = {static_cast<uint16_t>(take), static_cast<uint16_t>(seq.distance)};
+            tokens.push_back(match);
+            left -= take;
+        }
+        pos += seq.length;
+    }
+}
+
+// Run length code the literal/length and distance code lengths with symbols 16, 17 and 18
+static void runLengthCode(const vector<uint8_t>& lengths, vector<pair<uint8_t, uint8_t>>& symbols) {
+    symbols.clear();
+    size_t n = lengths.size();
+    for (size_t i = 0; i < n;) {
+        uint8_t cur = lengths[i];
+        size_t run = 1;
+        while (i + run < n && lengths[i + run] == cur) ++run;
+        i += run;
+
+        if (cur == 0) {
+            while (run >= 11) {
+                size_t r = min(run, static_cast<size_t>(138));
+                symbols.push_back(make_pair(static_cast<uint8_t>(18), static_cast<uint8_t>(r - 11)));
+                run -= r;
+            }
+            if (run >= 3) {
+                symbols.push_back(make_pair(static_cast<uint8_t>(17), static_cast<uint8_t>(run - 3)));
+                run = 0;
+            }
+        } else {
+            symbols.push_back(make_pair(cur, static_cast<uint8_t>(0)));
+            --run;
+            while (run >= 3) {
+                size_t r = min(run, static_cast<size_t>(6));
+                symbols.push_back(make_pair(static_cast<uint8_t>(16), static_cast<uint8_t>(r - 3)));
+                run -= r;
+            }
+        }
+        for (; run > 0; --run) symbols.push_back(make_pair(cur, static_cast<uint8_t>(0)));
+    }
+}
+
+// At least two codes per tree, some inflaters reject a lone code or an empty distance tree
+static void keepTwoCodes(vector<uint32_t>& freqs) {
+    int used = 0;
+    for (uint32_t f : freqs) used += f ? 1 : 0;
+    for (size_t s = 0; used < 2 && s < freqs.size(); ++s) {
+        if (!freqs[s]) {
+            freqs[s] = 1;
+            ++used;
+        }
+    }
+}
+
+static void planDynamicBlock(const DeflateToken* tokens, size_t count, DynamicBlock& block) {
+    // Step 1: Symbol statistics and the two main trees
+    vector<uint32_t> litFreq(LITLEN_SYMBOLS, 0), distFreq(DISTANCE_SYMBOLS, 0);
+    for (size_t i = 0; i < count; ++i) {
+        const DeflateToken& t = tokens[i];
+        if (t.length == 0) {
+            litFreq[t.value]++;
+        } else {
+            litFreq[257 + TABLES.lengthCode[t.length]]++;
+            distFreq[distanceCode(t.value)]++;
+        }
+    }
+    litFreq[END_OF_BLOCK] = 1;
+    keepTwoCodes(litFreq);
+    keepTwoCodes(distFreq);
+
+    block.litLengths = buildCodeLengths(litFreq, DEFLATE_MAX_BITS);
+    block.distLengths = buildCodeLengths(distFreq, DEFLATE_MAX_BITS);
+    block.litCodes = buildCanonicalCodes(block.litLengths);
+    block.distCodes = buildCanonicalCodes(block.distLengths);
+
+    block.hlit = LITLEN_SYMBOLS;
+    while (block.hlit > 257 && block.litLengths[block.hlit - 1] == 0) --block.hlit;
+    block.hdist = DISTANCE_SYMBOLS;
+    while (block.hdist > 1 && block.distLengths[block.hdist - 1] == 0) --block.hdist;
+
+    // Step 2: Both length lists go through the code length tree together
+    vector<uint8_t> all(block.litLengths.begin(), block.litLengths.begin() + block.hlit);
+    all.insert(all.end(), block.distLengths.begin(), block.distLengths.begin() + block.hdist);
+    runLengthCode(all, block.clSymbols);
+
+    vector<uint32_t> clFreq(CODE_LENGTH_SYMBOLS, 0);
+    for (const pair<uint8_t, uint8_t>& s : block.clSymbols) clFreq[s.first]++;
+    keepTwoCodes(clFreq);
+    block.clLengths = buildCodeLengths(clFreq, CODE_LENGTH_MAX_BITS);
+    block.clCodes = buildCanonicalCodes(block.clLengths);
+
+    block.hclen = CODE_LENGTH_SYMBOLS;
+    while (block.hclen > 4 && block.clLengths[CODE_LENGTH_ORDER[block.hclen - 1]] == 0) --block.hclen;
+
+    // Step 3: Size of the block as it would be written
+    uint64_t bits = 3 + 5 + 5 + 4 + 3 * static_cast<uint64_t>(block.hclen);
+    for (const pair<uint8_t, uint8_t>& s : block.clSymbols) {
+        bits += block.clLengths[s.first];
+        if (s.first == 16) bits += 2;
+        else if (s.first == 17) bits += 3;
+        else if (s.first == 18) bits += 7;
+    }
+    for (int s = 0; s < LITLEN_SYMBOLS; ++s) {
+        uint32_t extra = s > 256 ? LENGTH_EXTRA[s - 257] : 0;
+        bits += static_cast<uint64_t>(litFreq[s]) * (block.litLengths[s] + extra);
+    }
+    for (int s = 0; s < DISTANCE_SYMBOLS; ++s) {
+        bits += static_cast<uint64_t>(distFreq[s]) * (block.distLengths[s] + DISTANCE_EXTRA[s]);
+    }
+    block.bits = bits;
+}
+
+static void writeDynamicBlock(BitWriter& writer, const DeflateToken* tokens, size_t count,
+                              const DynamicBlock& block, bool last) {
+    writer.put(last ? 1 : 0, 1);
+    writer.put(2, 2);
+    writer.put(static_cast<uint32_t>(block.hlit - 257), 5);
+    writer.put(static_cast<uint32_t>(block.hdist - 1), 5);
+    writer.put(static_cast<uint32_t>(block.hclen - 4), 4);
+    for (int i = 0; i < block.hclen; ++i) writer.put(block.clLengths[CODE_LENGTH_ORDER[i]], 3);
+
+    for (const pair<uint8_t, uint8_t>& s : block.clSymbols) {
+        writer.put(block.clCodes[s.first], block.clLengths[s.first]);
+        if (s.first == 16) writer.put(s.second, 2);
+        else if (s.first == 17) writer.put(s.second, 3);
+        else if (s.first == 18) writer.put(s.second, 7);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        const DeflateToken& t = tokens[i];
+        if (t.length == 0) {
+            writer.put(block.litCodes[t.value], block.litLengths[t.value]);
+            continue;
+        }
+        int lc = TABLES.lengthCode[t.length];
+        writer.put(block.litCodes[257 + lc], block.litLengths[257 + lc]);
+        writer.put(t.length - LENGTH_BASE[lc], LENGTH_EXTRA[lc]);
+        int dc = distanceCode(t.value);
+        writer.put(block.distCodes[dc], block.distLengths[dc]);
+        writer.put(t.value - DISTANCE_BASE[dc], DISTANCE_EXTRA[dc]);
+    }
+    writer.put(block.litCodes[END_OF_BLOCK], block.litLengths[END_OF_BLOCK]);
+}
+
+// Stored blocks are byte aligned and hold at most 64 KB each
+static void writeStoredBlocks(BitWriter& writer, string& out, const uint8_t* data, size_t size, bool last) {
+    size_t pos = 0;
+    do {
+        size_t len = min(size - pos, STORED_MAX);
+        bool final = last && pos + len == size;
+        writer.put(final ? 1 : 0, 1);
+        writer.put(0, 2);
+        writer.flush();
+        out.push_back(static_cast<char>(len & 0xFF));
+        out.push_back(static_cast<char>(len >> 8));
+        out.push_back(static_cast<char>(~len & 0xFF));
+        out.push_back(static_cast<char>((~len >> 8) & 0xFF));
+        out.append(reinterpret_cast<const char*>(data + pos), len);
+        pos += len;
+    } while (pos < size);
+}
+
+static uint64_t storedBits(size_t size) {
+    size_t blocks = size == 0 ? 1 : (size + STORED_MAX - 1) / STORED_MAX;
+    return (static_cast<uint64_t>(size) + 5 * blocks) * 8 + 7;
+}
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Function to write a gzip member :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+static size_t readChunk(istream& in, string& buffer) {
+    buffer.resize(GZIP_CHUNK);
+    in.read(&buffer[0], buffer.size());
+    buffer.resize(static_cast<size_t>(in.gcount()));
+    return buffer.size();
+}
+
+bool compress_txt_gzip(istream& in, ostream& out, int level) {
+    LevelParams params = levelParams(level);
+    if (params.codec == BlockCodec::Bwt) params = levelParams(DEFAULT_GZIP_LEVEL);
+    params.lz.window = DEFLATE_WINDOW;
+    bool storedOnly = params.codec == BlockCodec::Stored;
+
+    // Step 1: Header, no name and no time stamp so equal input gives equal output
+    string bytes;
+    const char header[GZIP_HEADER_SIZE] = {
+        static_cast<char>(GZIP_ID1), static_cast<char>(GZIP_ID2), static_cast<char>(GZIP_DEFLATE),
+        0, 0, 0, 0, 0, 0, static_cast<char>(GZIP_OS_UNIX)};
+    bytes.assign(header, GZIP_HEADER_SIZE);
+
+    // Step 2: DEFLATE blocks, one chunk read ahead to know which block is the last
+    BitWriter writer(bytes);
+    uint32_t crc = 0;
+    uint64_t total = 0;
+    vector<LzSequence> sequences;
+    vector<DeflateToken> tokens;
+    DynamicBlock block;
+
+    string chunk, next;
+    readChunk(in, chunk);
+    do {
+        bool lastChunk = readChunk(in, next) == 0;
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(chunk.data());
+        crc = crc32Update(crc, data, chunk.size());
+        total += chunk.size();
+
+        if (storedOnly || chunk.empty()) {
+            writeStoredBlocks(writer, bytes, data, chunk.size(), lastChunk);
+        } else {
+            findSequences(data, chunk.size(), params.lz, sequences);
+            tokenize(data, sequences, tokens);
+
+            size_t pos = 0;
+            for (size_t first = 0; first < tokens.size(); first += BLOCK_TOKENS) {
+                size_t count = min(BLOCK_TOKENS, tokens.size() - first);
+                size_t span = 0;
+                for (size_t i = first; i < first + count; ++i) span += tokens[i].length ? tokens[i].length : 1;
+                bool last = lastChunk && first + count == tokens.size();
+
+                planDynamicBlock(&tokens[first], count, block);
+                if (block.bits < storedBits(span)) writeDynamicBlock(writer, &tokens[first], count, block, last);
+                else writeStoredBlocks(writer, bytes, data + pos, span, last);
+                pos += span;
+            }
+        }
+
+        out.write(bytes.data(), bytes.size());
+        bytes.clear();
+        chunk.swap(next);
+    } while (!chunk.empty());
+
+    // Step 3: Trailer
+    writer.flush();
+    putU32(bytes, crc);
+    putU32(bytes, static_cast<uint32_t>(total));
+    out.write(bytes.data(), bytes.size());
+    return static_cast<bool>(out);
+}
+
+void compress_txt_gzip_file(const string& inputFile, const string& outputFile, int level) {
+    ifstream inFile(inputFile, ios::in | ios::binary);
+    ofstream outFile(outputFile, ios::out | ios::binary);
+    if (!inFile.is_open() || !outFile.is_open()) {
+        cerr << "Error opening files!" << endl;
+        return;
+    }
+
+    if (!compress_txt_gzip(inFile, outFile, level < 0 ? DEFAULT_GZIP_LEVEL : level)) {
+        cerr << "Error writing compressed file!" << endl;
+        return;
+    }
+    cout << "Compression complete. Output written to " << outputFile << endl;
+}
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Inflater :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+namespace {
+
+// Decoded bytes stay in memory until they are out of the 32 KB window
+struct InflateOutput {
+    string window;
+    ostream& out;
+    uint32_t crc;
+    uint64_t total;
+
+    explicit InflateOutput(ostream& out) : out(out), crc(0), total(0) {}
+
+    void drain(bool all) {
+        size_t keep = all ? 0 : min(window.size(), static_cast<size_t>(DEFLATE_WINDOW));
+        size_t n = window.size() - keep;
+        if (n == 0) return;
+        out.write(window.data(), n);
+        crc = crc32Update(crc, reinterpret_cast<const uint8_t*>(window.data()), n);
+        total += n;
+        window.erase(0, n);
+    }
+};
+
+} // namespace
+
+static bool readCodeLengthTrees(BitReader& reader, HuffmanDecoder& litDecoder, HuffmanDecoder& distDecoder,
+                                bool& haveDistances) {
+    int hlit = static_cast<int>(reader.get(5)) + 257;
+    int hdist = static_cast<int>(reader.get(5)) + 1;
+    int hclen = static_cast<int>(reader.get(4)) + 4;
+    if (hlit > LITLEN_SYMBOLS || hdist > DISTANCE_SYMBOLS) return false;
+
+    vector<uint8_t> clLengths(CODE_LENGTH_SYMBOLS, 0);
+    for (int i = 0; i < hclen; ++i) clLengths[CODE_LENGTH_ORDER[i]] = static_cast<uint8_t>(reader.get(3));
+    HuffmanDecoder clDecoder;
+    if (!clDecoder.init(clLengths)) return false;
+
+    vector<uint8_t> lengths;
+    lengths.reserve(hlit + hdist);
+    while (lengths.size() < static_cast<size_t>(hlit + hdist)) {
+        int sym = clDecoder.decode(reader);
+        if (sym < 0) return false;
+        if (sym < 16) {
+            lengths.push_back(static_cast<uint8_t>(sym));
+            continue;
+        }
+        uint8_t value = 0;
+        size_t repeat;
+        if (sym == 16) {
+            if (lengths.empty()) return false;
+            value = lengths.back();
+            repeat = 3 + reader.get(2);
+        } else if (sym == 17) {
+            repeat = 3 + reader.get(3);
+        } else {
+            repeat = 11 + reader.get(7);
+        }
+        if (lengths.size() + repeat > static_cast<size_t>(hlit + hdist)) return false;
+        lengths.insert(lengths.end(), repeat, value);
+    }
+
+    vector<uint8_t> litLengths(lengths.begin(), lengths.begin() + hlit);
+    vector<uint8_t> distLengths(lengths.begin() + hlit, lengths.end());
+    if (litLengths[END_OF_BLOCK] == 0 || !litDecoder.init(litLengths)) return false;
+
+    // A block of literals only may send no distance codes at all
+    haveDistances = any_of(distLengths.begin(), distLengths.end(), [](uint8_t len) { return len != 0; });
+    return !haveDistances || distDecoder.init(distLengths);
+}
+
+static bool inflateCodes(BitReader& reader, const HuffmanDecoder& litDecoder, const HuffmanDecoder& distDecoder,
+                         bool haveDistances, InflateOutput& output) {
+    string& window = output.window;
+    while (true) {
+        int sym = litDecoder.decode(reader);
+        if (sym < 0 || reader.exhausted()) return false;
+        if (sym < 256) {
+            window.push_back(static_cast<char>(sym));
+            continue;
+        }
+        if (sym == END_OF_BLOCK) return true;
+
+        int lc = sym - 257;
+        if (lc >= 29 || !haveDistances) return false;
+        uint32_t length = LENGTH_BASE[lc] + reader.get(LENGTH_EXTRA[lc]);
+        int dc = distDecoder.decode(reader);
+        if (dc < 0 || dc >= DISTANCE_SYMBOLS) return false;
+        uint32_t dist = DISTANCE_BASE[dc] + reader.get(DISTANCE_EXTRA[dc]);
+        if (dist > window.size()) return false;
+
+        // Overlapping copies repeat the bytes just written, so go byte by byte then
+        size_t from = window.size() - dist;
+        if (dist >= length) {
+            window.append(window, from, length);
+        } else {
+            for (uint32_t k = 0; k < length; ++k) window.push_back(window[from + k]);
+        }
+
+        if (window.size() >= INFLATE_FLUSH + DEFLATE_WINDOW) output.drain(false);
+    }
+}
+
+// Skip the member header, returns its size or 0 if it is not a valid gzip header
+static size_t parseGzipHeader(const uint8_t* data, size_t size) {
+    if (size < GZIP_HEADER_SIZE || data[0] != GZIP_ID1 || data[1] != GZIP_ID2 || data[2] != GZIP_DEFLATE) return 0;
+    uint8_t flags = data[3];
+    size_t pos = GZIP_HEADER_SIZE;
+
+    if (flags & FLAG_EXTRA) {
+        if (pos + 2 > size) return 0;
+        pos += 2 + (data[pos] | (data[pos + 1] << 8));
+    }
+    for (uint8_t field : {FLAG_NAME, FLAG_COMMENT}) {
+        if (!(flags & field)) continue;
+        while (pos < size && data[pos] != 0) ++pos;
+        ++pos;
+    }
+    if (flags & FLAG_HCRC) pos += 2;
+    return pos <= size ? pos : 0;
+}
+
+bool decompress_txt_gzip(istream& in, ostream& out) {
+    string input((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(input.data());
+    size_t size = input.size();
+
+    // Fixed Huffman codes of block type 1
+    vector<uint8_t> fixedLit(288, 8), fixedDist(DISTANCE_SYMBOLS, 5);
+    fill(fixedLit.begin() + 144, fixedLit.begin() + 256, 9);
+    fill(fixedLit.begin() + 256, fixedLit.begin() + 280, 7);
+    HuffmanDecoder fixedLitDecoder, fixedDistDecoder, litDecoder, distDecoder;
+    fixedLitDecoder.init(fixedLit);
+    fixedDistDecoder.init(fixedDist);
+
+    size_t pos = 0;
+    int members = 0;
+    while (pos < size) {
+        // Step 1: Member header (trailing zero padding after the last member is ignored)
+        size_t headerSize = parseGzipHeader(data + pos, size - pos);
+        if (headerSize == 0) {
+            if (members > 0 && all_of(data + pos, data + size, [](uint8_t b) { return b == 0; })) break;
+            cerr << "Invalid gzip header, corrupted file!" << endl;
+            return false;
+        }
+        pos += headerSize;
+
+        // Step 2: DEFLATE blocks
+        InflateOutput output(out);
+        BitReader reader(data + pos, size - pos);
+        size_t base = pos;
+        bool last = false;
+        while (!last) {
+            last = reader.get(1) != 0;
+            uint32_t type = reader.get(2);
+            bool ok;
+            if (type == 0) {
+                reader.alignToByte();
+                size_t at = base + reader.bytePosition();
+                if (at + 4 > size) return false;
+                uint32_t len = data[at] | (data[at + 1] << 8);
+                uint32_t nlen = data[at + 2] | (data[at + 3] << 8);
+                ok = (len ^ 0xFFFF) == nlen && at + 4 + len <= size;
+                if (ok) {
+                    output.window.append(reinterpret_cast<const char*>(data + at + 4), len);
+                    base = at + 4 + len;
+                    reader = BitReader(data + base, size - base);
+                    if (output.window.size() >= INFLATE_FLUSH + DEFLATE_WINDOW) output.drain(false);
+                }
+            } else if (type == 1) {
+                ok = inflateCodes(reader, fixedLitDecoder, fixedDistDecoder, true, output);
+            } else if (type == 2) {
+                bool haveDistances = false;
+                ok = readCodeLengthTrees(reader, litDecoder, distDecoder, haveDistances) &&
+                     inflateCodes(reader, litDecoder, distDecoder, haveDistances, output);
+            } else {
+                ok = false;
+            }
+            if (!ok || reader.exhausted()) {
+                cerr << "Invalid DEFLATE block, corrupted file!" << endl;
+                return false;
+            }
+        }
+        output.drain(true);
+
+        // Step 3: Trailer
+        reader.alignToByte();
+        pos = base + reader.bytePosition();
+        if (pos + 8 > size) {
+            cerr << "Truncated gzip trailer, corrupted file!" << endl;
+            return false;
+        }
+        if (getU32(data + pos) != output.crc || getU32(data + pos + 4) != static_cast<uint32_t>(output.total)) {
+            cerr << "gzip CRC or size mismatch, corrupted file!" << endl;
+            return false;
+        }
+        pos += 8;
+        ++members;
+    }
+    return true;
+}
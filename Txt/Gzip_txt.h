@@ -0,0 +1,27 @@
+#ifndef TXT_GZIP_H
+#define TXT_GZIP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+/*
+gzip (RFC 1952) output for consumers that only read gzip. The DEFLATE (RFC 1951) stream
+is parsed by the txt LZ engine with its window capped at 32 KB and written as dynamic
+Huffman blocks, or stored blocks where those come out smaller. The inflater reads any
+gzip file: stored, fixed and dynamic blocks and concatenated members.
+*/
+
+const size_t GZIP_HEADER_SIZE = 10;
+
+bool isGzipMagic(const char* bytes, size_t size);
+
+// Levels follow the txt ladder; BWT levels fall back to the default LZ level
+bool compress_txt_gzip(std::istream& in, std::ostream& out, int level);
+void compress_txt_gzip_file(const std::string& inputFile, const std::string& outputFile, int level);
+
+// Decode every member of a gzip file, checking CRC and size of each
+bool decompress_txt_gzip(std::istream& in, std::ostream& out);
+
+#endif
@@ -0,0 +1,205 @@
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include "Huffman_txt.h"
+#include "Checksum_txt.h"
+
+using namespace std;
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Function to build length limited code lengths :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+vector<uint8_t> buildCodeLengths(const vector<uint32_t>& freqs, int maxBits) {
+    vector<uint8_t> lengths(freqs.size(), 0);
+
+    vector<int> used;
+    for (size_t i = 0; i < freqs.size(); ++i) {
+        if (freqs[i] > 0) used.push_back(static_cast<int>(i));
+    }
+
+    if (used.empty()) return lengths;
+    if (used.size() == 1) {
+        lengths[used[0]] = 1;
+        return lengths;
+    }
+
+    // Step 1: Plain Huffman tree, nodes kept in a flat array with parent links
+    size_t leaves = used.size();
+    vector<int> parent(2 * leaves - 1, -1);
+    typedef pair<uint64_t, int> Item;
+    priority_queue<Item, vector<Item>, greater<Item>> heap;
+    for (size_t i = 0; i < leaves; ++i) {
+        heap.push(Item(freqs[used[i]], static_cast<int>(i)));
+    }
+
+    int next = static_cast<int>(leaves);
+    while (heap.size() > 1) {
+        Item a = heap.top(); heap.pop();
+        Item b = heap.top(); heap.pop();
+        parent[a.second] = next;
+        parent[b.second] = next;
+        heap.push(Item(a.first + b.first, next));
+        ++next;
+    }
+
+    // Step 2: Count leaves per depth
+    vector<int> depth(parent.size(), 0);
+    for (int i = next - 2; i >= 0; --i) {
+        depth[i] = depth[parent[i]] + 1;
+    }
+
+    int deepest = 0;
+    for (size_t i = 0; i < leaves; ++i) deepest = max(deepest, depth[i]);
+
+    vector<int> counts(max(deepest, maxBits) + 1, 0);
+    for (size_t i = 0; i < leaves; ++i) counts[depth[i]]++;
+
+    // Step 3: Push overlong codes back under the limit (JPEG Annex K.3 style)
+    for (int i = deepest; i > maxBits; --i) {
+        while (counts[i] > 0) {
+            int j = i - 2;
+            while (counts[j] == 0) --j;
+            counts[i] -= 2;
+            counts[i - 1] += 1;
+            counts[j + 1] += 2;
+            counts[j] -= 1;
+        }
+    }
+
+    // Step 4: Hand out the shortest lengths to the most frequent symbols
+    stable_sort(used.begin(), used.end(), [&freqs](int a, int b) { return freqs[a] > freqs[b]; });
+    size_t k = 0;
+    for (int len = 1; len <= maxBits; ++len) {
+        for (int c = 0; c < counts[len]; ++c) {
+            lengths[used[k++]] = static_cast<uint8_t>(len);
+        }
+    }
+
+    return lengths;
+}
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Function to assign canonical codes :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+static uint32_t reverseBits(uint32_t code, int len) {
+    uint32_t out = 0;
+    for (int i = 0; i < len; ++i) {
+        out = (out << 1) | (code & 1);
+        code >>= 1;
+    }
+    return out;
+}
+
+vector<uint32_t> buildCanonicalCodes(const vector<uint8_t>& lengths) {
+    int maxLen = 0;
+    for (uint8_t len : lengths) maxLen = max(maxLen, static_cast<int>(len));
+
+    vector<uint32_t> counts(maxLen + 1, 0);
+    for (uint8_t len : lengths) {
+        if (len) counts[len]++;
+    }
+
+    vector<uint32_t> nextCode(maxLen + 2, 0);
+    uint32_t code = 0;
+    for (int len = 1; len <= maxLen; ++len) {
+        code = (code + counts[len - 1]) << 1;
+        nextCode[len] = code;
+    }
+
+    vector<uint32_t> codes(lengths.size(), 0);
+    for (size_t s = 0; s < lengths.size(); ++s) {
+        int len = lengths[s];
+        if (len) codes[s] = reverseBits(nextCode[len]++, len);
+    }
+    return codes;
+}
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Table driven decoder :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+bool HuffmanDecoder::init(const vector<uint8_t>& lengths) {
+    bits = 0;
+    for (uint8_t len : lengths) bits = max(bits, static_cast<int>(len));
+    if (bits == 0 || bits > HUFFMAN_MAX_BITS) return false;
+
+    // Kraft sum must not exceed one, otherwise codes overlap
+    uint64_t kraft = 0;
+    for (uint8_t len : lengths) {
+        if (len) kraft += 1ull << (bits - len);
+    }
+    if (kraft > (1ull << bits)) return false;
+
+    table.assign(static_cast<size_t>(1) << bits, 0);
+    vector<uint32_t> codes = buildCanonicalCodes(lengths);
+    for (size_t s = 0; s < lengths.size(); ++s) {
+        int len = lengths[s];
+        if (!len) continue;
+        uint32_t entry = (static_cast<uint32_t>(s) << 4) | static_cast<uint32_t>(len);
+        for (uint32_t fill = codes[s]; fill < table.size(); fill += 1u << len) {
+            table[fill] = entry;
+        }
+    }
+    return true;
+}
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Code table serialization and order-0 byte coding :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+void writeCodeLengths(string& out, const vector<uint8_t>& lengths) {
+    for (size_t s = 0; s < lengths.size(); s += 2) {
+        uint8_t high = s + 1 < lengths.size() ? lengths[s + 1] : 0;
+        out.push_back(static_cast<char>(lengths[s] | (high << 4)));
+    }
+}
+
+bool readCodeLengths(const uint8_t* data, size_t size, size_t symbols, vector<uint8_t>& lengths) {
+    if (size < codeTableSize(symbols)) return false;
+    lengths.assign(symbols, 0);
+    for (size_t s = 0; s < symbols; ++s) {
+        lengths[s] = (s & 1) ? data[s / 2] >> 4 : data[s / 2] & 0xF;
+    }
+    return true;
+}
+
+void encodeBytes(const uint8_t* data, size_t size, const vector<uint8_t>& lengths,
+                 const vector<uint32_t>& codes, string& out) {
+    BitWriter writer(out);
+    for (size_t i = 0; i < size; ++i) {
+        writer.put(codes[data[i]], lengths[data[i]]);
+    }
+    writer.flush();
+}
+
+bool decodeBytes(const uint8_t* data, size_t size, const HuffmanDecoder& decoder,
+                 size_t rawSize, string& out, BlockChecksum* checksum) {
+    BitReader reader(data, size);
+    size_t start = out.size();
+    out.resize(start + rawSize);
+    uint8_t* dst = reinterpret_cast<uint8_t*>(&out[0] + start);
+    for (size_t i = 0; i < rawSize;) {
+        size_t chunkEnd = min(rawSize, i + CHECKSUM_CHUNK);
+        for (; i < chunkEnd; ++i) {
+            int sym = decoder.decode(reader);
+            if (sym < 0) return false;
+            dst[i] = static_cast<uint8_t>(sym);
+        }
+        if (checksum) checksum->update(dst, i);
+    }
+    return !reader.exhausted();
+}
@@ -0,0 +1,136 @@
+#ifndef TXT_HUFFMAN_H
+#define TXT_HUFFMAN_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class BlockChecksum;
+
+// Canonical, length-limited Huffman coding shared by the block based txt codecs.
+// Bits are packed LSB first so the same reader and writer can serve every format.
+
+const int HUFFMAN_MAX_BITS = 15;
+
+// Code length per symbol (0 = unused), no code longer than maxBits.
+std::vector<uint8_t> buildCodeLengths(const std::vector<uint32_t>& freqs, int maxBits);
+
+// Canonical codes for the given lengths, already bit reversed for LSB first output.
+std::vector<uint32_t> buildCanonicalCodes(const std::vector<uint8_t>& lengths);
+
+class BitWriter {
+public:
+    explicit BitWriter(std::string& out) : out(out), acc(0), count(0) {}
+
+    void put(uint32_t bits, int n) {
+        acc |= static_cast<uint64_t>(bits) << count;
+        count += n;
+        while (count >= 8) {
+            out.push_back(static_cast<char>(acc & 0xFF));
+            acc >>= 8;
+            count -= 8;
+        }
+    }
+
+    // Pad the last partial byte with zero bits
+    void flush() {
+        if (count > 0) {
+            out.push_back(static_cast<char>(acc & 0xFF));
+        }
+        acc = 0;
+        count = 0;
+    }
+
+private:
+    std::string& out;
+    uint64_t acc;
+    int count;
+};
+
+class BitReader {
+public:
+    BitReader(const uint8_t* data, size_t size) : data(data), size(size), pos(0), acc(0), count(0) {}
+
+    uint32_t peek(int n) {
+        if (count < n) refill();
+        return static_cast<uint32_t>(acc & ((1ull << n) - 1));
+    }
+
+    void consume(int n) {
+        acc >>= n;
+        count -= n;
+    }
+
+    uint32_t get(int n) {
+        if (n == 0) return 0;
+        uint32_t v = peek(n);
+        consume(n);
+        return v;
+    }
+
+    // Drop the bits left in the current byte
+    void alignToByte() { consume(count & 7); }
+
+    // Byte offset of the next unread bit, only meaningful after alignToByte()
+    size_t bytePosition() const { return pos - count / 8; }
+
+    // True once more bits were consumed than the input holds
+    bool exhausted() const { return pos * 8 - count > size * 8; }
+
+private:
+    void refill() {
+        while (count <= 56) {
+            uint64_t byte = 0;
+            if (pos < size) byte = data[pos];
+            ++pos;
+            acc |= byte << count;
+            count += 8;
+        }
+    }
+
+    const uint8_t* data;
+    size_t size;
+    size_t pos;
+    uint64_t acc;
+    int count;
+};
+
+class HuffmanDecoder {
+public:
+    HuffmanDecoder() : bits(0) {}
+
+    // Returns false if the lengths do not describe a usable prefix code
+    bool init(const std::vector<uint8_t>& lengths);
+
+    // Returns the next symbol, or -1 on an invalid code
+    int decode(BitReader& reader) const {
+        uint32_t entry = table[reader.peek(bits)];
+        int len = entry & 0xF;
+        if (len == 0) return -1;
+        reader.consume(len);
+        return static_cast<int>(entry >> 4);
+    }
+
+private:
+    std::vector<uint32_t> table; // (symbol << 4) | length, indexed by the next 'bits' input bits
+    int bits;
+};
+
+// Code tables are stored as their code lengths, 4 bits each
+inline size_t codeTableSize(size_t symbols) { return (symbols + 1) / 2; }
+
+void writeCodeLengths(std::string& out, const std::vector<uint8_t>& lengths);
+bool readCodeLengths(const uint8_t* data, size_t size, size_t symbols, std::vector<uint8_t>& lengths);
+
+// Order-0 byte tables cover all 256 byte values
+const size_t BYTE_TABLE_SIZE = 128;
+
+// Encode / decode a run of bytes with an order-0 byte table. checksum, if given, is
+// updated while the bytes are decoded.
+void encodeBytes(const uint8_t* data, size_t size, const std::vector<uint8_t>& lengths,
+                 const std::vector<uint32_t>& codes, std::string& out);
+bool decodeBytes(const uint8_t* data, size_t size, const HuffmanDecoder& decoder,
+                 size_t rawSize, std::string& out, BlockChecksum* checksum = nullptr);
+
+#endif
@@ -0,0 +1,144 @@
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include "Info_txt.h"
+#include "Container_txt.h"
+#include "Archive_txt.h"
+#include "Lines_txt.h"
+
+using namespace std;
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Metadata reads :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+static const char* codecName(BlockCodec codec) {
+    switch (codec) {
+        case BlockCodec::End:     return "auto (picked per block)";
+        case BlockCodec::Stored:  return "stored";
+        case BlockCodec::Huffman: return "Huffman";
+        case BlockCodec::Lz:      return "LZ + Huffman";
+        case BlockCodec::Bwt:     return "BWT + MTF + Huffman";
+    }
+    return "unknown";
+}
+
+// Header and index through pread, files without an index offset through their block headers
+static bool loadInfo(const string& compressedFile, ContainerInfo& info, uint64_t& fileSize, bool& scanned) {
+    int fd = open(compressedFile.c_str(), O_RDONLY);
+    if (fd < 0) {
+        cerr << "Error opening input file." << endl;
+        return false;
+    }
+    bool indexed = readContainerIndex(fd, info, fileSize);
+    close(fd);
+    scanned = !indexed;
+    if (indexed) return true;
+
+    // readContainerInfo reports everything but a missing magic
+    ifstream inFile(compressedFile, ios::binary);
+    char head[CONTAINER_MAGIC_SIZE + 2];
+    if (!inFile.read(head, sizeof(head)) || containerVersion(head, sizeof(head)) < 1) {
+        cerr << "Not a block based container (older releases wrote no header)." << endl;
+        return false;
+    }
+    inFile.seekg(0);
+    if (!readContainerInfo(inFile, info)) return false;
+    inFile.clear();
+    inFile.seekg(0, ios::end);
+    fileSize = static_cast<uint64_t>(inFile.tellg());
+    return true;
+}
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Export Functions :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+bool info_txt_file(const string& compressedFile) {
+    ContainerInfo info;
+    uint64_t fileSize = 0;
+    bool scanned;
+    if (!loadInfo(compressedFile, info, fileSize, scanned)) return false;
+
+    size_t counts[5] = {0};
+    size_t far = 0;
+    for (const BlockEntry& entry : info.blocks) {
+        if (static_cast<size_t>(entry.codec) < 5) counts[static_cast<size_t>(entry.codec)]++;
+        if (entry.flags & BLOCK_FLAG_FAR) ++far;
+    }
+
+    cout << "File:             " << compressedFile << endl;
+    cout << "Format:           container version " << info.version << endl;
+    cout << "Codec:            " << codecName(info.codec) << endl;
+    cout << "Original size:    " << info.originalSize << " bytes" << endl;
+    cout << "Compressed size:  " << fileSize << " bytes" << endl;
+    if (info.originalSize > 0 && fileSize > 0) {
+        cout << "Ratio:            " << fixed << setprecision(2) << static_cast<double>(info.originalSize) / fileSize
+             << ":1 (" << setprecision(1) << 100.0 * fileSize / info.originalSize << "% of the original)" << endl;
+    }
+    cout << "Blocks:           " << info.blocks.size() << " of up to " << info.blockSize << " bytes: "
+         << counts[static_cast<size_t>(BlockCodec::Stored)] << " stored, "
+         << counts[static_cast<size_t>(BlockCodec::Huffman)] << " Huffman, "
+         << counts[static_cast<size_t>(BlockCodec::Lz)] << " LZ, "
+         << counts[static_cast<size_t>(BlockCodec::Bwt)] << " BWT";
+    if (far) cout << ", " << far << " with far matches";
+    cout << endl;
+
+    cout << "Checksums:        ";
+    if (!(info.flags & CONTAINER_FLAG_CHECKSUMS)) {
+        cout << "none" << endl;
+    } else {
+        cout << "CRC-32C of every block, whole data 0x" << hex << setw(8) << setfill('0') << info.checksum << dec
+             << setfill(' ') << endl;
+    }
+    cout << "Index:            " << (scanned ? "rebuilt from the block headers" : "read from the header offset")
+         << endl;
+
+    // Index sections
+    for (const pair<uint32_t, string>& section : info.sections) {
+        if (section.first == SECTION_LINE_INDEX) {
+            vector<LineEntry> lines;
+            uint64_t count = 0;
+            if (decodeLineIndex(section.second, info.blocks.size(), lines)) {
+                for (const LineEntry& entry : lines) count += entry.lines;
+            }
+            cout << "Line index:       " << count << " lines" << endl;
+        }
+    }
+    if (hasFileTable(info)) {
+        vector<ArchiveEntry> entries;
+        if (!findFileTable(info, entries)) return false;
+        size_t files = 0;
+        for (const ArchiveEntry& entry : entries) files += entry.type == ArchiveEntryType::File;
+        cout << "Archive:          " << files << " files, " << entries.size() - files << " directories" << endl;
+    }
+    return true;
+}
+
+bool list_txt_archive(const string& compressedFile) {
+    ContainerInfo info;
+    uint64_t fileSize = 0;
+    bool scanned;
+    if (!loadInfo(compressedFile, info, fileSize, scanned)) return false;
+
+    vector<ArchiveEntry> entries;
+    if (!findFileTable(info, entries)) return false;
+    size_t files = 0;
+    for (const ArchiveEntry& entry : entries) {
+        bool directory = entry.type == ArchiveEntryType::Directory;
+        cout << oct << setw(4) << setfill('0') << entry.mode << dec << setfill(' ') << ' ' << setw(12) << entry.size
+             << ' ' << entry.path << (directory ? "/" : "") << endl;
+        files += !directory;
+    }
+    cout << files << " files, " << entries.size() - files << " directories, " << info.originalSize << " bytes" << endl;
+    return true;
+}
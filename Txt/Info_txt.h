@@ -0,0 +1,21 @@
+#ifndef TXT_INFO_H
+#define TXT_INFO_H
+
+#include <string>
+
+/*
+Metadata of block based containers without decoding anything: the header and the index are read
+with two preads (see readContainerIndex), whatever the size of the payload. Only files without
+an index offset in their header (--stream to a pipe) fall back to walking the block headers,
+which still skips every payload.
+*/
+
+// Codec, sizes, ratio, block table summary, checksums and index sections; false if the file
+// cannot be read (reported)
+bool info_txt_file(const std::string& compressedFile);
+
+// Files and directories of an archive (see Archive_txt.h) with their permission bits and sizes;
+// false if the file is no readable archive (reported)
+bool list_txt_archive(const std::string& compressedFile);
+
+#endif
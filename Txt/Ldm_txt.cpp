@@ -0,0 +1,209 @@
+#include <algorithm>
+#include "Ldm_txt.h"
+#include "Container_txt.h"
+
+using namespace std;
+
+
+static const uint64_t NO_POSITION = ~static_cast<uint64_t>(0);
+static const size_t COMPARE_CHUNK = 64 * 1024;
+static const size_t FAR_MATCH_SIZE = 16;
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Gear rolling hash :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+// Each step shifts the hash left by one, so after 64 bytes the oldest byte has left
+// the hash and its top bits depend on the whole window.
+namespace {
+
+struct GearTable {
+    uint64_t values[256];
+
+    GearTable() {
+        // splitmix64, any fixed set of random looking values works
+        uint64_t state = 0x9E3779B97F4A7C15ull;
+        for (int i = 0; i < 256; ++i) {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            values[i] = z ^ (z >> 31);
+        }
+    }
+};
+
+} // namespace
+
+static const GearTable GEAR;
+
+const uint64_t* gearTable() {
+    return GEAR.values;
+}
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Far match search :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+LongDistanceMatcher::LongDistanceMatcher(istream& history, int tableBits)
+    : history(history)
+    , tableBits(tableBits)
+    , rolling(0)
+    , seen(0)
+{
+}
+
+bool LongDistanceMatcher::readHistory(uint64_t position, size_t size) {
+    buffer.resize(size);
+    history.clear();
+    history.seekg(static_cast<streamoff>(position));
+    history.read(&buffer[0], size);
+    return static_cast<size_t>(history.gcount()) == size;
+}
+
+// Length of the match at offset against source, grown backwards no further than low
+uint32_t LongDistanceMatcher::extend(const uint8_t* data, size_t size, size_t offset, size_t low, uint64_t source,
+                                     uint64_t blockStart, uint32_t& back) {
+    back = 0;
+
+    // Step 1: Forwards, the source may not run into the block itself
+    size_t forward = 0;
+    size_t maxForward = static_cast<size_t>(min(static_cast<uint64_t>(size - offset), blockStart - source));
+    while (forward < maxForward) {
+        size_t chunk = min(COMPARE_CHUNK, maxForward - forward);
+        if (!readHistory(source + forward, chunk)) break;
+        size_t k = 0;
+        while (k < chunk && static_cast<uint8_t>(buffer[k]) == data[offset + forward + k]) ++k;
+        forward += k;
+        if (k < chunk) break;
+    }
+    if (forward < LDM_WINDOW) return 0;
+
+    // Step 2: Backwards, up to the previous far match
+    size_t maxBack = static_cast<size_t>(min(static_cast<uint64_t>(offset - low), source));
+    if (maxBack && readHistory(source - maxBack, maxBack)) {
+        while (back < maxBack && static_cast<uint8_t>(buffer[maxBack - 1 - back]) == data[offset - 1 - back]) ++back;
+    }
+    return static_cast<uint32_t>(forward + back);
+}
+
+void LongDistanceMatcher::process(const uint8_t* data, size_t size, uint64_t blockStart, vector<FarMatch>& matches) {
+    matches.clear();
+    if (table.empty()) {
+        Entry empty = {0, NO_POSITION};
+        table.assign(static_cast<size_t>(1) << tableBits, empty);
+    }
+
+    // Fingerprints of this block only become visible to later blocks
+    vector<pair<size_t, Entry>> pending;
+    size_t covered = 0;
+
+    for (size_t i = 0; i < size; ++i) {
+        rolling = (rolling << 1) + GEAR.values[data[i]];
+        if (++seen < LDM_WINDOW || (rolling >> (64 - LDM_SPLIT_BITS)) != 0) continue;
+
+        size_t slot = static_cast<size_t>((rolling * 0x9E3779B97F4A7C15ull) >> (64 - tableBits));
+        uint32_t check = static_cast<uint32_t>(rolling);
+        Entry entry = {check, blockStart + i + 1 - LDM_WINDOW};
+        pending.push_back(make_pair(slot, entry));
+
+        // Only windows inside the block and past the last far match are searched
+        if (i + 1 < LDM_WINDOW || i + 1 - LDM_WINDOW < covered) continue;
+        const Entry& candidate = table[slot];
+        if (candidate.position == NO_POSITION || candidate.check != check) continue;
+
+        size_t offset = i + 1 - LDM_WINDOW;
+        uint32_t back;
+        uint32_t length = extend(data, size, offset, covered, candidate.position, blockStart, back);
+        if (length < LDM_MIN_MATCH) continue;
+
+        FarMatch match = {static_cast<uint32_t>(offset - back), length, candidate.position - back};
+        matches.push_back(match);
+        covered = match.offset + match.length;
+    }
+
+    for (const pair<size_t, Entry>& p : pending) table[p.first] = p.second;
+}
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Far match lists :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+string removeFarMatches(const uint8_t* data, size_t size, const vector<FarMatch>& matches) {
+    string residual;
+    size_t pos = 0;
+    for (const FarMatch& m : matches) {
+        residual.append(reinterpret_cast<const char*>(data + pos), m.offset - pos);
+        pos = m.offset + m.length;
+    }
+    residual.append(reinterpret_cast<const char*>(data + pos), size - pos);
+    return residual;
+}
+
+void writeFarMatches(string& out, const vector<FarMatch>& matches) {
+    putU32(out, static_cast<uint32_t>(matches.size()));
+    for (const FarMatch& m : matches) {
+        putU32(out, m.offset);
+        putU32(out, m.length);
+        putU32(out, static_cast<uint32_t>(m.source));
+        putU32(out, static_cast<uint32_t>(m.source >> 32));
+    }
+}
+
+bool readFarMatches(const uint8_t* data, size_t size, size_t rawSize, uint64_t blockStart,
+                    vector<FarMatch>& matches, size_t& used) {
+    matches.clear();
+    if (size < 4) return false;
+    uint32_t count = getU32(data);
+    if (count > (size - 4) / FAR_MATCH_SIZE) return false;
+
+    size_t end = 0;
+    const uint8_t* p = data + 4;
+    for (uint32_t i = 0; i < count; ++i, p += FAR_MATCH_SIZE) {
+        FarMatch m;
+        m.offset = getU32(p);
+        m.length = getU32(p + 4);
+        m.source = getU32(p + 8) | (static_cast<uint64_t>(getU32(p + 12)) << 32);
+
+        // In order, inside the block, and copied from data that is already decoded
+        if (m.length == 0 || m.offset < end || m.offset > rawSize || m.length > rawSize - m.offset) return false;
+        if (m.source > blockStart || m.length > blockStart - m.source) return false;
+        end = m.offset + m.length;
+        matches.push_back(m);
+    }
+    used = 4 + static_cast<size_t>(count) * FAR_MATCH_SIZE;
+    return true;
+}
+
+bool applyFarMatches(const vector<FarMatch>& matches, istream& history, const string& residual,
+                     size_t rawSize, string& block) {
+    block.clear();
+    block.reserve(rawSize);
+
+    size_t pos = 0;
+    for (const FarMatch& m : matches) {
+        size_t gap = m.offset - block.size();
+        if (gap > residual.size() - pos) return false;
+        block.append(residual, pos, gap);
+        pos += gap;
+
+        size_t at = block.size();
+        block.resize(at + m.length);
+        history.clear();
+        history.seekg(static_cast<streamoff>(m.source));
+        history.read(&block[at], m.length);
+        if (static_cast<size_t>(history.gcount()) != m.length) return false;
+    }
+
+    if (residual.size() - pos != rawSize - block.size()) return false;
+    block.append(residual, pos, string::npos);
+    return true;
+}
@@ -0,0 +1,79 @@
+#ifndef TXT_LDM_H
+#define TXT_LDM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+Long distance matching. A gear rolling hash runs over the whole input and every position
+whose hash has its top LDM_SPLIT_BITS bits clear (one in 64 on average) fingerprints the
+LDM_WINDOW bytes before it. Fingerprints of earlier blocks live in one table, so repeats
+hundreds of MB apart are found without a sliding window.
+
+Matched ranges are cut out of the block before the block codec runs. The block carries
+BLOCK_FLAG_FAR and its payload starts with the far match list:
+    u32 count
+    count x (u32 offset in block, u32 length, u32 source low, u32 source high)
+followed by the payload of the remaining bytes. Sources are absolute positions in the
+original data and always end before the block starts, so the decoder copies them from
+the output it has already written.
+*/
+
+const size_t LDM_WINDOW = 64;
+const int LDM_SPLIT_BITS = 6;
+const uint32_t LDM_MIN_MATCH = 64;
+
+// 256 random looking 64-bit values, the gear hash adds the one of every byte it shifts in
+const uint64_t* gearTable();
+
+struct FarMatch {
+    uint32_t offset;   // Start inside the block
+    uint32_t length;
+    uint64_t source;   // Absolute position of the copy source
+};
+
+class LongDistanceMatcher {
+public:
+    // history reads the data seen so far, e.g. a second handle on the input file.
+    // The fingerprint table is only allocated by the first block.
+    explicit LongDistanceMatcher(std::istream& history, int tableBits = 20);
+
+    // Find far matches for the block at blockStart, then fingerprint the block for later ones.
+    // Blocks have to be passed in order.
+    void process(const uint8_t* data, size_t size, uint64_t blockStart, std::vector<FarMatch>& matches);
+
+private:
+    struct Entry {
+        uint32_t check;
+        uint64_t position;   // Start of the fingerprinted window
+    };
+
+    std::istream& history;
+    int tableBits;
+    std::vector<Entry> table;
+    uint64_t rolling;
+    uint64_t seen;
+    std::string buffer;
+
+    bool readHistory(uint64_t position, size_t size);
+    uint32_t extend(const uint8_t* data, size_t size, size_t offset, size_t low, uint64_t source, uint64_t blockStart,
+                    uint32_t& back);
+};
+
+// Bytes of the block that are not covered by far matches
+std::string removeFarMatches(const uint8_t* data, size_t size, const std::vector<FarMatch>& matches);
+
+void writeFarMatches(std::string& out, const std::vector<FarMatch>& matches);
+
+// Parse and validate the far match list at the start of a payload, used is its size in bytes
+bool readFarMatches(const uint8_t* data, size_t size, size_t rawSize, uint64_t blockStart,
+                    std::vector<FarMatch>& matches, size_t& used);
+
+// Rebuild a block from its remaining bytes and sources read back from history
+bool applyFarMatches(const std::vector<FarMatch>& matches, std::istream& history, const std::string& residual,
+                     size_t rawSize, std::string& block);
+
+#endif
@@ -0,0 +1,155 @@
+#include <chrono>
+#include <fstream>
+#include "Levels_txt.h"
+#include "Bwt_txt.h"
+#include "Compress_txt.h"
+#include "Huffman_txt.h"
+
+using namespace std;
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Level ladder :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+LevelParams levelParams(int level) {
+    if (level < MIN_LEVEL) level = MIN_LEVEL;
+    if (level > MAX_LEVEL) level = MAX_LEVEL;
+
+    //                                codec               block size     chain  nice   parser
+    static const LevelParams table[MAX_LEVEL + 1] = {
+        /*  0 */ {BlockCodec::Stored, 1 << 20,        {0,     0,     LzParser::Greedy}},
+        /*  1 */ {BlockCodec::Lz,     256 << 10,      {1,     16,    LzParser::Greedy}},
+        /*  2 */ {BlockCodec::Lz,     256 << 10,      {2,     24,    LzParser::Greedy}},
+        /*  3 */ {BlockCodec::Lz,     512 << 10,      {4,     32,    LzParser::Greedy}},
+        /*  4 */ {BlockCodec::Lz,     1 << 20,        {8,     48,    LzParser::Greedy}},
+        /*  5 */ {BlockCodec::Lz,     1 << 20,        {4,     32,    LzParser::Lazy}},
+        /*  6 */ {BlockCodec::Lz,     1 << 20,        {8,     64,    LzParser::Lazy}},
+        /*  7 */ {BlockCodec::Lz,     1 << 20,        {16,    96,    LzParser::Lazy}},
+        /*  8 */ {BlockCodec::Lz,     2 << 20,        {24,    128,   LzParser::Lazy}},
+        /*  9 */ {BlockCodec::Lz,     2 << 20,        {32,    192,   LzParser::Lazy}},
+        /* 10 */ {BlockCodec::Lz,     4 << 20,        {16,    32,    LzParser::Optimal}},
+        /* 11 */ {BlockCodec::Lz,     4 << 20,        {24,    32,    LzParser::Optimal}},
+        /* 12 */ {BlockCodec::Lz,     4 << 20,        {32,    32,    LzParser::Optimal}},
+        /* 13 */ {BlockCodec::Lz,     4 << 20,        {48,    32,    LzParser::Optimal}},
+        /* 14 */ {BlockCodec::Lz,     8 << 20,        {64,    32,    LzParser::Optimal}},
+        /* 15 */ {BlockCodec::Lz,     8 << 20,        {128,   32,    LzParser::Optimal}},
+        /* 16 */ {BlockCodec::Bwt,    512 << 10,      {0,     0,     LzParser::Greedy}},
+        /* 17 */ {BlockCodec::Bwt,    1 << 20,        {0,     0,     LzParser::Greedy}},
+        /* 18 */ {BlockCodec::Bwt,    2 << 20,        {0,     0,     LzParser::Greedy}},
+        /* 19 */ {BlockCodec::Bwt,    4 << 20,        {0,     0,     LzParser::Greedy}},
+    };
+    return table[level];
+}
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Function to compress a single block :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+void compressBlock(const LevelParams& params, const uint8_t* data, size_t size, BlockHeader& header, string& payload) {
+    header.codec = params.codec;
+    header.flags = 0;
+    header.rawSize = static_cast<uint32_t>(size);
+    payload.clear();
+
+    switch (params.codec) {
+        case BlockCodec::Huffman: {
+            vector<uint8_t> lengths = buildCodeLengths(countFrequencies(data, size), HUFFMAN_MAX_BITS);
+            writeCodeLengths(payload, lengths);
+            encodeBytes(data, size, lengths, buildCanonicalCodes(lengths), payload);
+            header.flags |= BLOCK_FLAG_TABLE;
+            break;
+        }
+        case BlockCodec::Lz:
+            encodeLzBlock(data, size, params.lz, payload);
+            break;
+        case BlockCodec::Bwt:
+            encodeBwtBlock(data, size, payload);
+            break;
+        default:
+            break;
+    }
+
+    // Incompressible data (or level 0) is kept as is
+    if (params.codec == BlockCodec::Stored || payload.size() >= size) {
+        header.codec = BlockCodec::Stored;
+        header.flags = 0;
+        payload.assign(reinterpret_cast<const char*>(data), size);
+    }
+    header.payloadSize = static_cast<uint32_t>(payload.size());
+}
+
+
+void compressBlockFar(const LevelParams& params, const uint8_t* data, size_t size, const vector<FarMatch>& far,
+                      BlockHeader& header, string& payload) {
+    if (far.empty()) {
+        compressBlock(params, data, size, header, payload);
+        return;
+    }
+
+    string residual = removeFarMatches(data, size, far);
+    string inner;
+    compressBlock(params, reinterpret_cast<const uint8_t*>(residual.data()), residual.size(), header, inner);
+
+    payload.clear();
+    writeFarMatches(payload, far);
+    payload += inner;
+    header.flags |= BLOCK_FLAG_FAR;
+    header.rawSize = static_cast<uint32_t>(size);
+    header.payloadSize = static_cast<uint32_t>(payload.size());
+}
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Export Function :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+void compress_txt_level(const string& inputFile, const string& outputFile, int level, bool longDistance, bool lineIndex) {
+    ifstream inFile(inputFile, ios::in | ios::binary);
+    ofstream outFile(outputFile, ios::out | ios::binary);
+    ifstream history(inputFile, ios::in | ios::binary);
+    if (!inFile.is_open() || !outFile.is_open() || !history.is_open()) {
+        cerr << "Error opening files!" << endl;
+        return;
+    }
+    LongDistanceMatcher matcher(history);
+    vector<FarMatch> far;
+
+    LevelParams params = levelParams(level);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    ContainerWriter writer(outFile, params.codec, static_cast<uint32_t>(params.blockSize));
+    if (lineIndex) writer.indexLines();
+
+    string block, payload;
+    BlockHeader header;
+    while (true) {
+        block.resize(params.blockSize);
+        inFile.read(&block[0], block.size());
+        block.resize(static_cast<size_t>(inFile.gcount()));
+        if (block.empty()) break;
+
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(block.data());
+        if (longDistance) matcher.process(data, block.size(), writer.rawBytes(), far);
+        compressBlockFar(params, data, block.size(), far, header, payload);
+        writer.writeBlock(header, payload, data, block.size());
+    }
+
+    if (!writer.finish()) {
+        cerr << "Error writing compressed file!" << endl;
+        return;
+    }
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "Level " << level << ": " << writer.rawBytes() << " -> " << writer.bytesWritten() << " bytes";
+    if (seconds > 0) cout << " at " << static_cast<int>(writer.rawBytes() / seconds / 1e6) << " MB/s";
+    cout << endl;
+    cout << "Compression complete. Output written to " << outputFile << endl;
+}
@@ -0,0 +1,52 @@
+#ifndef TXT_LEVELS_H
+#define TXT_LEVELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "Container_txt.h"
+#include "Ldm_txt.h"
+#include "Lz_txt.h"
+
+/*
+Compression levels, from fastest to strongest. Every level decodes with the same block decoders,
+so decompression speed depends only on the engine.
+
+Throughput of the block engines alone (in memory, no file I/O), measured on one core of a Xeon
+VM with -O2, for English prose (Harry_Potter.txt, 437 KB, one block at every level) and for
+synthetic web server logs (16 MB). Runs vary by about 20% on that machine; a slower CPU or the
+file I/O of the command line tool lowers every figure.
+
+    level   engine                           block       compress MB/s        decompress MB/s
+                                                         prose     logs       prose     logs
+      0     stored                           1 MB        > 300     > 300      memcpy    memcpy
+     1-4    LZ + Huffman, greedy             256K-1M     18-40     65-100     150-200   300-500
+     5-9    LZ + Huffman, lazy               1-2 MB      10-18     17-55      150-210   350-500
+    10-15   LZ + Huffman, optimal parse      4-8 MB      2.5-3     1.5-2.5    ~200      350-550
+    16-19   BWT + MTF + Huffman              512K-4M     4-5       2.5-6      25-30     9-35
+*/
+
+const int MIN_LEVEL = 0;
+const int MAX_LEVEL = 19;
+
+struct LevelParams {
+    BlockCodec codec;
+    size_t blockSize;
+    LzParams lz;
+};
+
+LevelParams levelParams(int level);
+
+// Compress one block with the engine of the level, incompressible blocks are stored
+void compressBlock(const LevelParams& params, const uint8_t* data, size_t size, BlockHeader& header, std::string& payload);
+
+// Same, with the far matches cut out first and listed in front of the payload
+void compressBlockFar(const LevelParams& params, const uint8_t* data, size_t size, const std::vector<FarMatch>& far,
+                      BlockHeader& header, std::string& payload);
+
+// longDistance runs the long distance matcher over the whole input before the block codec,
+// lineIndex records the line index section (see Lines_txt.h)
+void compress_txt_level(const std::string& inputFile, const std::string& outputFile, int level,
+                        bool longDistance = false, bool lineIndex = false);
+
+#endif
@@ -0,0 +1,73 @@
+#include <algorithm>
+#include <cstring>
+#include "Lines_txt.h"
+#include "Container_txt.h"
+
+using namespace std;
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Counting line starts :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+LineEntry LineCounter::add(const uint8_t* data, size_t size) {
+    LineEntry entry = {0, NO_LINE_START};
+    if (size == 0) return entry;
+
+    // Newlines before the last byte start a line in this block, the last one in the next
+    const uint8_t* last = data + size - 1;
+    if (lineStartPending) {
+        entry.lines = 1;
+        entry.firstLine = 0;
+    }
+    uint32_t inside = static_cast<uint32_t>(count(data, last, '\n'));
+    if (inside > 0 && entry.firstLine == NO_LINE_START) {
+        const void* first = memchr(data, '\n', size - 1);
+        entry.firstLine = static_cast<uint32_t>(static_cast<const uint8_t*>(first) - data + 1);
+    }
+    entry.lines += inside;
+    lineStartPending = *last == '\n';
+    return entry;
+}
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Index section :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+string encodeLineIndex(const vector<LineEntry>& entries) {
+    string out;
+    putU32(out, static_cast<uint32_t>(entries.size()));
+    for (const LineEntry& e : entries) {
+        putU32(out, e.lines);
+        putU32(out, e.firstLine);
+    }
+    return out;
+}
+
+bool decodeLineIndex(const string& section, size_t blockCount, vector<LineEntry>& entries) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(section.data());
+    if (section.size() < 4 || getU32(p) != blockCount || section.size() != 4 + blockCount * 8) return false;
+    entries.resize(blockCount);
+    for (size_t i = 0; i < blockCount; ++i) {
+        entries[i].lines = getU32(p + 4 + 8 * i);
+        entries[i].firstLine = getU32(p + 8 + 8 * i);
+    }
+    return true;
+}
+
+size_t skipLines(const uint8_t* data, size_t size, uint64_t n) {
+    const uint8_t* p = data;
+    const uint8_t* end = data + size;
+    while (n > 0 && p < end) {
+        const void* found = memchr(p, '\n', static_cast<size_t>(end - p));
+        if (!found) return size;
+        p = static_cast<const uint8_t*>(found) + 1;
+        --n;
+    }
+    return n == 0 ? static_cast<size_t>(p - data) : size;
+}
@@ -0,0 +1,46 @@
+#ifndef TXT_LINES_H
+#define TXT_LINES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+Sparse line index, stored as an index section of the container (--line-index). For every block
+it keeps how many lines start in the block and where the first of them starts:
+    u32 block count, then per block u32 line count, u32 first line offset
+A line starts at offset 0 and after every '\n' that is not the last byte of the data. With the
+counts a reader finds the block holding any line number, and the first line of each block can
+be reached without decoding the blocks before it.
+*/
+
+const uint32_t SECTION_LINE_INDEX = 1;
+
+// First line offset of blocks in which no line starts (a line longer than the block)
+const uint32_t NO_LINE_START = 0xFFFFFFFF;
+
+struct LineEntry {
+    uint32_t lines;       // Lines starting in the block
+    uint32_t firstLine;   // Offset of the first of them in the block, NO_LINE_START if none
+};
+
+// Counts the line starts of consecutive blocks. A '\n' at the end of a block starts a
+// line in the next block, so it is only counted once that block turns out not to be empty.
+class LineCounter {
+public:
+    LineCounter() : lineStartPending(true) {}
+
+    LineEntry add(const uint8_t* data, size_t size);
+
+private:
+    bool lineStartPending;
+};
+
+std::string encodeLineIndex(const std::vector<LineEntry>& entries);
+bool decodeLineIndex(const std::string& section, size_t blockCount, std::vector<LineEntry>& entries);
+
+// Offset just past the n-th '\n' (n >= 1) in data, size if there are fewer
+size_t skipLines(const uint8_t* data, size_t size, uint64_t n);
+
+#endif
@@ -0,0 +1,580 @@
+#include <algorithm>
+#include <cstring>
+#include "Lz_txt.h"
+#include "Huffman_txt.h"
+#include "Checksum_txt.h"
+
+using namespace std;
+
+
+/*
+Block payload:
+    literal/length code lengths    256 literals followed by LENGTH_CODES match length codes
+    distance code lengths          DISTANCE_CODES codes
+    bitstream                      literals, or length code + extra bits + distance code + extra bits
+
+Lengths (minus LZ_MIN_MATCH) and distances (minus one) use log buckets: values below a
+small direct range get their own code, larger ones a code per half power of two plus
+extra bits, the same idea as DEFLATE but wide enough for whole blocks.
+*/
+
+static const int LENGTH_DIRECT_BITS = 4;
+static const int DISTANCE_DIRECT_BITS = 2;
+static const int VALUE_BITS = 24;
+
+static const int LENGTH_CODES = (1 << LENGTH_DIRECT_BITS) + 2 * (VALUE_BITS - LENGTH_DIRECT_BITS);
+static const int DISTANCE_CODES = (1 << DISTANCE_DIRECT_BITS) + 2 * (VALUE_BITS - DISTANCE_DIRECT_BITS);
+static const int LITLEN_CODES = 256 + LENGTH_CODES;
+
+static const int MIN_HASH_BITS = 12;
+static const int MAX_HASH_BITS = 20;
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Log bucket value coding :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+static inline int highestBit(uint32_t v) {
+    return 31 - __builtin_clz(v);
+}
+
+static inline int valueCode(uint32_t v, int directBits, int& extraBits, uint32_t& extra) {
+    if (v < (1u << directBits)) {
+        extraBits = 0;
+        extra = 0;
+        return static_cast<int>(v);
+    }
+    int nb = highestBit(v);
+    extraBits = nb - 1;
+    extra = v & ((1u << extraBits) - 1);
+    return (1 << directBits) + 2 * (nb - directBits) + static_cast<int>((v >> extraBits) & 1);
+}
+
+static inline uint32_t valueFromCode(int code, int directBits, BitReader& reader) {
+    if (code < (1 << directBits)) return static_cast<uint32_t>(code);
+    int k = code - (1 << directBits);
+    int nb = k / 2 + directBits;
+    uint32_t top = 2u | static_cast<uint32_t>(k & 1);
+    return (top << (nb - 1)) | reader.get(nb - 1);
+}
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Hash chain match finder :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+static inline uint32_t read32(const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t hash4(const uint8_t* p, int bits) {
+    return (read32(p) * 2654435761u) >> (32 - bits);
+}
+
+namespace {
+
+struct Match {
+    uint32_t length;
+    uint32_t distance;
+};
+
+struct HashChain {
+    const uint8_t* data;
+    size_t size;
+    const LzParams& params;
+    int hashBits;
+    vector<int32_t> head;
+    vector<int32_t> prev;
+
+    // Hash table sized to the block so unrelated positions rarely share a chain
+    HashChain(const uint8_t* data, size_t size, const LzParams& params)
+        : data(data)
+        , size(size)
+        , params(params)
+        , hashBits(max(MIN_HASH_BITS, min(MAX_HASH_BITS, size > 1 ? highestBit(static_cast<uint32_t>(size - 1)) + 1 : 0)))
+        , head(static_cast<size_t>(1) << hashBits, -1)
+        , prev(size, -1)
+    {
+    }
+
+    void insert(size_t pos) {
+        uint32_t h = hash4(data + pos, hashBits);
+        prev[pos] = head[h];
+        head[h] = static_cast<int32_t>(pos);
+    }
+
+    Match find(size_t pos) const {
+        Match best = {0, 0};
+        size_t limit = min(size - pos, static_cast<size_t>(LZ_MAX_MATCH));
+        if (limit < LZ_MIN_MATCH) return best;
+
+        const uint8_t* cur = data + pos;
+        uint32_t first = read32(cur);
+        int32_t cand = head[hash4(cur, hashBits)];
+        uint32_t good = max(8, params.niceLength / 8);
+        bool shortened = false;
+        for (int depth = params.chainDepth; cand >= 0 && depth > 0; --depth, cand = prev[cand]) {
+            // Chains run from near to far, nothing further on is in reach either
+            if (params.window && pos - cand > params.window) break;
+            const uint8_t* ref = data + cand;
+            if (read32(ref) != first) continue;
+            if (best.length >= LZ_MIN_MATCH && ref[best.length] != cur[best.length]) continue;
+
+            uint32_t len = LZ_MIN_MATCH;
+            while (len < limit && ref[len] == cur[len]) ++len;
+            if (len > best.length) {
+                best.length = len;
+                best.distance = static_cast<uint32_t>(pos - cand);
+                if (len >= static_cast<uint32_t>(params.niceLength) || len == limit) break;
+
+                // A good match is already in hand, only skim the rest of the chain
+                if (len >= good && !shortened) {
+                    depth = depth / 4 + 1;
+                    shortened = true;
+                }
+            }
+        }
+        return best;
+    }
+};
+
+} // namespace
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Greedy / lazy parser :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+static void findChainSequences(const uint8_t* data, size_t size, const LzParams& params, vector<LzSequence>& sequences) {
+    HashChain chain(data, size, params);
+
+    size_t pos = 0;
+    size_t literalStart = 0;
+    while (pos + LZ_MIN_MATCH <= size) {
+        Match m = chain.find(pos);
+        chain.insert(pos);
+        if (m.length < LZ_MIN_MATCH) {
+            ++pos;
+            continue;
+        }
+
+        // A longer match one byte later is worth a literal
+        if (params.parser == LzParser::Lazy) {
+            while (m.length < static_cast<uint32_t>(params.niceLength) && pos + 1 + LZ_MIN_MATCH <= size) {
+                Match next = chain.find(pos + 1);
+                if (next.length <= m.length) break;
+                chain.insert(++pos);
+                m = next;
+            }
+        }
+
+        LzSequence seq = {static_cast<uint32_t>(pos - literalStart), m.length, m.distance};
+        sequences.push_back(seq);
+
+        size_t end = pos + m.length;
+        for (size_t i = pos + 1; i < end && i + LZ_MIN_MATCH <= size; ++i) chain.insert(i);
+        pos = end;
+        literalStart = pos;
+    }
+
+    if (literalStart < size) {
+        LzSequence tail = {static_cast<uint32_t>(size - literalStart), 0, 0};
+        sequences.push_back(tail);
+    }
+}
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Code lengths of a parse :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+static void buildLzTables(const uint8_t* data, const vector<LzSequence>& sequences,
+                          vector<uint8_t>& litLengths, vector<uint8_t>& distLengths) {
+    vector<uint32_t> litFreq(LITLEN_CODES, 0), distFreq(DISTANCE_CODES, 0);
+    int extraBits;
+    uint32_t extra;
+    size_t pos = 0;
+    for (const LzSequence& seq : sequences) {
+        for (uint32_t i = 0; i < seq.literals; ++i) litFreq[data[pos + i]]++;
+        pos += seq.literals;
+        if (seq.length) {
+            litFreq[256 + valueCode(seq.length - LZ_MIN_MATCH, LENGTH_DIRECT_BITS, extraBits, extra)]++;
+            distFreq[valueCode(seq.distance - 1, DISTANCE_DIRECT_BITS, extraBits, extra)]++;
+            pos += seq.length;
+        }
+    }
+    litLengths = buildCodeLengths(litFreq, HUFFMAN_MAX_BITS);
+    distLengths = buildCodeLengths(distFreq, HUFFMAN_MAX_BITS);
+}
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Binary tree match finder :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+namespace {
+
+// Every hash bucket holds a binary search tree of earlier positions ordered by the bytes
+// that follow them, so one descent yields matches of strictly increasing length.
+struct BinaryTree {
+    const uint8_t* data;
+    size_t size;
+    int hashBits;
+    int maxDepth;
+    uint32_t nice;
+    uint32_t window;
+    vector<int32_t> head;
+    vector<int32_t> son;   // son[2p] smaller suffixes, son[2p + 1] larger ones
+
+    BinaryTree(const uint8_t* data, size_t size, const LzParams& params)
+        : data(data)
+        , size(size)
+        , hashBits(max(MIN_HASH_BITS, min(MAX_HASH_BITS, size > 1 ? highestBit(static_cast<uint32_t>(size - 1)) + 1 : 0)))
+        , maxDepth(params.chainDepth)
+        , nice(static_cast<uint32_t>(params.niceLength))
+        , window(params.window)
+        , head(static_cast<size_t>(1) << hashBits, -1)
+        , son(2 * size, -1)
+    {
+    }
+
+    // Insert pos and, when matches is given, collect its matches (shortest first)
+    void update(size_t pos, vector<Match>* matches) {
+        if (matches) matches->clear();
+        if (pos + LZ_MIN_MATCH > size) return;
+
+        const uint8_t* cur = data + pos;
+        uint32_t limit = static_cast<uint32_t>(min(size - pos, static_cast<size_t>(nice)));
+        uint32_t h = hash4(cur, hashBits);
+        int32_t cand = head[h];
+        head[h] = static_cast<int32_t>(pos);
+
+        int32_t* smaller = &son[2 * pos];
+        int32_t* larger = &son[2 * pos + 1];
+        uint32_t smallerLen = 0, largerLen = 0, best = LZ_MIN_MATCH - 1;
+
+        for (int depth = maxDepth; ; --depth) {
+            // Nodes out of the window are cut off together with everything below them
+            if (cand < 0 || depth == 0 || (window && pos - cand > window)) {
+                *smaller = -1;
+                *larger = -1;
+                break;
+            }
+
+            const uint8_t* ref = data + cand;
+            uint32_t len = min(smallerLen, largerLen);
+            while (len < limit && ref[len] == cur[len]) ++len;
+
+            if (matches && len > best) {
+                best = len;
+                Match m = {len, static_cast<uint32_t>(pos - cand)};
+                matches->push_back(m);
+            }
+
+            // Equal up to the limit: pos takes over the node and its subtrees
+            if (len == limit) {
+                *smaller = son[2 * cand];
+                *larger = son[2 * cand + 1];
+                break;
+            }
+
+            if (ref[len] < cur[len]) {
+                *smaller = cand;
+                smaller = &son[2 * cand + 1];
+                cand = *smaller;
+                smallerLen = len;
+            } else {
+                *larger = cand;
+                larger = &son[2 * cand];
+                cand = *larger;
+                largerLen = len;
+            }
+        }
+
+        // The tree only compares up to 'nice' bytes, stretch the longest match by hand
+        if (matches && !matches->empty() && matches->back().length == nice) {
+            Match& longest = matches->back();
+            size_t end = min(size - pos, static_cast<size_t>(LZ_MAX_MATCH));
+            const uint8_t* ref = cur - longest.distance;
+            while (longest.length < end && ref[longest.length] == cur[longest.length]) ++longest.length;
+        }
+    }
+};
+
+// Bit prices taken from the code lengths of an earlier parse, extra bits included
+struct LzPrices {
+    uint32_t literal[256];
+    vector<uint32_t> length;     // per match length up to the longest the parser relaxes
+    vector<uint32_t> distance;   // per distance code
+
+    LzPrices(const vector<uint8_t>& litLengths, const vector<uint8_t>& distLengths, uint32_t maxLength)
+        : length(maxLength + 1, 0), distance(DISTANCE_CODES)
+    {
+        // Symbols the first parse never used still need a finite, unattractive price
+        const uint32_t unused = HUFFMAN_MAX_BITS + 1;
+        int extraBits;
+        uint32_t extra;
+        for (int c = 0; c < 256; ++c) literal[c] = litLengths[c] ? litLengths[c] : unused;
+        for (uint32_t len = LZ_MIN_MATCH; len <= maxLength; ++len) {
+            int code = valueCode(len - LZ_MIN_MATCH, LENGTH_DIRECT_BITS, extraBits, extra);
+            length[len] = (litLengths[256 + code] ? litLengths[256 + code] : unused) + extraBits;
+        }
+        for (int c = 0; c < DISTANCE_CODES; ++c) {
+            uint32_t bits = distLengths[c] ? distLengths[c] : unused;
+            distance[c] = bits + (c < (1 << DISTANCE_DIRECT_BITS) ? 0 : (c - (1 << DISTANCE_DIRECT_BITS)) / 2 + DISTANCE_DIRECT_BITS - 1);
+        }
+    }
+
+    uint32_t distancePrice(uint32_t dist) const {
+        int extraBits;
+        uint32_t extra;
+        return distance[valueCode(dist - 1, DISTANCE_DIRECT_BITS, extraBits, extra)];
+    }
+};
+
+} // namespace
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Optimal parser :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+static const size_t OPT_WINDOW = 4096;
+static const uint32_t PRICE_INFINITY = 0xFFFFFFFFu;
+
+// Forward dynamic program over windows of about OPT_WINDOW positions: price[r] is the
+// cheapest way to reach window offset r. A window closes at the first position past
+// OPT_WINDOW that no match jumps over, so no path has to be cut short there.
+static void findOptimalSequences(const uint8_t* data, size_t size, const LzParams& params,
+                                 const LzPrices& prices, vector<LzSequence>& sequences) {
+    sequences.clear();
+    BinaryTree tree(data, size, params);
+
+    const size_t span = OPT_WINDOW + static_cast<size_t>(params.niceLength);
+    vector<uint32_t> price(span + 1), stepLength(span + 1), stepDistance(span + 1);
+    vector<Match> matches;
+    vector<uint32_t> path;
+    uint32_t literals = 0;
+
+    size_t pos = 0;
+    while (pos < size) {
+        size_t start = pos;
+        size_t limit = min(size, start + span);
+        size_t reach = start;
+        size_t end = start;
+        fill(price.begin(), price.end(), PRICE_INFINITY);
+        price[0] = 0;
+
+        // Step 1: Relax a literal and every match length from each position
+        Match forced = {0, 0};
+        for (size_t i = start; i < limit; ++i) {
+            if (i == reach && i - start >= OPT_WINDOW) break;
+            size_t r = i - start;
+            tree.update(i, &matches);
+
+            // Long matches are taken as they are, the window is cut short in front of them
+            if (!matches.empty() && matches.back().length >= static_cast<uint32_t>(params.niceLength)) {
+                forced = matches.back();
+                end = i;
+                break;
+            }
+
+            uint32_t base = price[r];
+            uint32_t lit = base + prices.literal[data[i]];
+            if (lit < price[r + 1]) {
+                price[r + 1] = lit;
+                stepLength[r + 1] = 1;
+            }
+            reach = max(reach, i + 1);
+
+            uint32_t len = LZ_MIN_MATCH;
+            for (const Match& m : matches) {
+                uint32_t top = static_cast<uint32_t>(min(static_cast<size_t>(m.length), limit - i));
+                uint32_t matchBase = base + prices.distancePrice(m.distance);
+                for (; len <= top; ++len) {
+                    uint32_t cost = matchBase + prices.length[len];
+                    if (cost < price[r + len]) {
+                        price[r + len] = cost;
+                        stepLength[r + len] = len;
+                        stepDistance[r + len] = m.distance;
+                    }
+                }
+                reach = max(reach, i + top);
+            }
+            end = reach;
+        }
+
+        // Step 2: Walk back from the window end and replay the chosen steps
+        path.clear();
+        for (size_t r = end - start; r > 0; r -= stepLength[r]) path.push_back(static_cast<uint32_t>(r));
+        for (size_t k = path.size(); k-- > 0;) {
+            uint32_t r = path[k];
+            if (stepLength[r] == 1) {
+                ++literals;
+            } else {
+                LzSequence seq = {literals, stepLength[r], stepDistance[r]};
+                sequences.push_back(seq);
+                literals = 0;
+            }
+        }
+        pos = end;
+
+        // Step 3: Emit the long match and only insert the positions it covers
+        if (forced.length) {
+            LzSequence seq = {literals, forced.length, forced.distance};
+            sequences.push_back(seq);
+            literals = 0;
+            for (size_t i = pos + 1; i < pos + forced.length; ++i) tree.update(i, nullptr);
+            pos += forced.length;
+        }
+    }
+
+    if (literals) {
+        LzSequence tail = {literals, 0, 0};
+        sequences.push_back(tail);
+    }
+}
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Function to parse a block :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+void findSequences(const uint8_t* data, size_t size, const LzParams& params, vector<LzSequence>& sequences) {
+    sequences.clear();
+    if (params.parser != LzParser::Optimal) {
+        findChainSequences(data, size, params, sequences);
+        return;
+    }
+
+    // A quick lazy parse provides the statistics the optimal parse is priced with
+    LzParams seed = {8, 32, LzParser::Lazy, params.window};
+    findChainSequences(data, size, seed, sequences);
+    vector<uint8_t> litLengths, distLengths;
+    buildLzTables(data, sequences, litLengths, distLengths);
+
+    findOptimalSequences(data, size, params, LzPrices(litLengths, distLengths, params.niceLength), sequences);
+}
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Entropy coding of the parse :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+void encodeLzSequences(const uint8_t* data, size_t size, const vector<LzSequence>& sequences, string& out) {
+    // Step 1: Code tables from the symbol statistics
+    vector<uint8_t> litLengths, distLengths;
+    buildLzTables(data, sequences, litLengths, distLengths);
+    vector<uint32_t> litCodes = buildCanonicalCodes(litLengths);
+    vector<uint32_t> distCodes = buildCanonicalCodes(distLengths);
+    writeCodeLengths(out, litLengths);
+    writeCodeLengths(out, distLengths);
+
+    // Step 2: Bitstream
+    BitWriter writer(out);
+    int extraBits;
+    uint32_t extra;
+    size_t pos = 0;
+    for (const LzSequence& seq : sequences) {
+        for (uint32_t i = 0; i < seq.literals; ++i) {
+            uint8_t c = data[pos + i];
+            writer.put(litCodes[c], litLengths[c]);
+        }
+        pos += seq.literals;
+        if (!seq.length) continue;
+
+        int code = 256 + valueCode(seq.length - LZ_MIN_MATCH, LENGTH_DIRECT_BITS, extraBits, extra);
+        writer.put(litCodes[code], litLengths[code]);
+        writer.put(extra, extraBits);
+
+        code = valueCode(seq.distance - 1, DISTANCE_DIRECT_BITS, extraBits, extra);
+        writer.put(distCodes[code], distLengths[code]);
+        writer.put(extra, extraBits);
+        pos += seq.length;
+    }
+    writer.flush();
+}
+
+void encodeLzBlock(const uint8_t* data, size_t size, const LzParams& params, string& out) {
+    vector<LzSequence> sequences;
+    findSequences(data, size, params, sequences);
+    encodeLzSequences(data, size, sequences, out);
+}
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Decoder :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+bool decodeLzBlock(const uint8_t* data, size_t size, size_t rawSize, string& out, BlockChecksum* checksum) {
+    size_t litTable = codeTableSize(LITLEN_CODES);
+    size_t distTable = codeTableSize(DISTANCE_CODES);
+    vector<uint8_t> litLengths, distLengths;
+    if (!readCodeLengths(data, size, LITLEN_CODES, litLengths) ||
+        !readCodeLengths(data + litTable, size - litTable, DISTANCE_CODES, distLengths)) {
+        return false;
+    }
+
+    HuffmanDecoder litDecoder, distDecoder;
+    bool haveDistances = false;
+    for (uint8_t len : distLengths) haveDistances |= len != 0;
+    if (rawSize > 0 && !litDecoder.init(litLengths)) return false;
+    if (haveDistances && !distDecoder.init(distLengths)) return false;
+
+    BitReader reader(data + litTable + distTable, size - litTable - distTable);
+    size_t start = out.size();
+    out.resize(start + rawSize);
+    uint8_t* dst = reinterpret_cast<uint8_t*>(&out[0] + start);
+
+    // Checksummed a chunk at a time, matches may run past the end of a chunk
+    size_t pos = 0;
+    while (pos < rawSize) {
+        size_t chunkEnd = min(rawSize, pos + CHECKSUM_CHUNK);
+        while (pos < chunkEnd) {
+            int sym = litDecoder.decode(reader);
+            if (sym < 0) return false;
+            if (sym < 256) {
+                dst[pos++] = static_cast<uint8_t>(sym);
+                continue;
+            }
+
+            if (!haveDistances) return false;
+            uint32_t length = valueFromCode(sym - 256, LENGTH_DIRECT_BITS, reader) + LZ_MIN_MATCH;
+            int dsym = distDecoder.decode(reader);
+            if (dsym < 0) return false;
+            uint32_t distance = valueFromCode(dsym, DISTANCE_DIRECT_BITS, reader) + 1;
+            if (distance > pos || length > rawSize - pos) return false;
+
+            uint8_t* target = dst + pos;
+            const uint8_t* source = target - distance;
+            if (distance >= length) {
+                memcpy(target, source, length);
+            } else {
+                for (uint32_t i = 0; i < length; ++i) target[i] = source[i];
+            }
+            pos += length;
+        }
+        if (checksum) checksum->update(dst, pos);
+    }
+    return !reader.exhausted();
+}
@@ -0,0 +1,47 @@
+#ifndef TXT_LZ_H
+#define TXT_LZ_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class BlockChecksum;
+
+// LZ77 + Huffman block codec. Matches never reach outside the block, so every block
+// decodes on its own.
+
+const uint32_t LZ_MIN_MATCH = 4;
+const uint32_t LZ_MAX_MATCH = 1 << 20;
+
+enum class LzParser {
+    Greedy,    // Take the longest match at each position
+    Lazy,      // Check the next position before committing to a match
+    Optimal,   // Cheapest parse under the code lengths of a first pass
+};
+
+struct LzParams {
+    int chainDepth;   // Hash chain candidates (or binary tree nodes) examined per position
+    int niceLength;   // Stop searching once a match this long is found
+    LzParser parser;
+    uint32_t window;  // Farthest match distance, 0 for the whole block
+};
+
+// A run of literals followed by a match (length 0 for the trailing literals)
+struct LzSequence {
+    uint32_t literals;
+    uint32_t length;
+    uint32_t distance;
+};
+
+void findSequences(const uint8_t* data, size_t size, const LzParams& params, std::vector<LzSequence>& sequences);
+
+// Entropy code a parse of data into a block payload
+void encodeLzSequences(const uint8_t* data, size_t size, const std::vector<LzSequence>& sequences, std::string& out);
+
+void encodeLzBlock(const uint8_t* data, size_t size, const LzParams& params, std::string& out);
+// checksum, if given, is updated while the block is decoded
+bool decodeLzBlock(const uint8_t* data, size_t size, size_t rawSize, std::string& out,
+                   BlockChecksum* checksum = nullptr);
+
+#endif
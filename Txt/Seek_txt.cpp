@@ -0,0 +1,242 @@
+#include <algorithm>
+#include <cstring>
+#include "Seek_txt.h"
+#include "Checksum_txt.h"
+
+using namespace std;
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+History for far matches :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+// Far matches read their sources through an istream (the output file when the whole container
+// is decoded). Here that stream decodes the earlier blocks it is asked for through the reader.
+namespace {
+
+class HistoryBuffer : public streambuf {
+public:
+    explicit HistoryBuffer(ContainerReader& reader) : reader(reader), position(0) {}
+
+protected:
+    pos_type seekoff(off_type off, ios_base::seekdir dir, ios_base::openmode) override {
+        if (dir == ios_base::cur) off += position;
+        else if (dir != ios_base::beg) return pos_type(off_type(-1));
+        position = static_cast<uint64_t>(off);
+        return pos_type(off);
+    }
+
+    pos_type seekpos(pos_type pos, ios_base::openmode mode) override {
+        return seekoff(off_type(pos), ios_base::beg, mode);
+    }
+
+    streamsize xsgetn(char* s, streamsize n) override {
+        if (n <= 0 || !reader.read(position, static_cast<size_t>(n), s)) return 0;
+        position += static_cast<uint64_t>(n);
+        return n;
+    }
+
+private:
+    ContainerReader& reader;
+    uint64_t position;
+};
+
+} // namespace
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Container reader :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+ContainerReader::ContainerReader(istream& in, size_t cacheBlocks)
+    : in(in)
+    , base(0)
+    , cacheBlocks(max(cacheBlocks, static_cast<size_t>(1)))
+    , decoded(0)
+{
+}
+
+bool ContainerReader::open() {
+    base = in.tellg();
+    cache.clear();
+    linesBefore.clear();
+    return readContainerInfo(in, container);
+}
+
+size_t ContainerReader::findBlock(uint64_t offset) const {
+    if (offset >= container.originalSize) return container.blocks.size();
+    vector<BlockEntry>::const_iterator it = upper_bound(
+        container.blocks.begin(), container.blocks.end(), offset,
+        [](uint64_t value, const BlockEntry& entry) { return value < entry.rawOffset; });
+    return static_cast<size_t>(it - container.blocks.begin()) - 1;
+}
+
+bool ContainerReader::decodeBlock(size_t index, string& block) {
+    const BlockEntry& entry = container.blocks[index];
+    BlockDecoder decoder;
+    BlockHeader header;
+    vector<uint8_t> payload;
+
+    // Step 1: Huffman blocks without a table use the one of the closest block before them that has one
+    if (entry.codec == BlockCodec::Huffman && !(entry.flags & BLOCK_FLAG_TABLE)) {
+        size_t owner = index;
+        while (owner > 0 && !(container.blocks[owner - 1].codec == BlockCodec::Huffman &&
+                              (container.blocks[owner - 1].flags & BLOCK_FLAG_TABLE))) {
+            --owner;
+        }
+        if (owner == 0) {
+            cerr << "Huffman block without a code table, corrupted file!" << endl;
+            return false;
+        }
+        const BlockEntry& tableEntry = container.blocks[owner - 1];
+        if (!readBlock(in, base, tableEntry, header, payload) ||
+            !decoder.loadTable(header, payload.data(), tableEntry.rawOffset)) {
+            return false;
+        }
+    }
+
+    // Step 2: The block itself, far matches decode their sources through the reader again
+    if (!readBlock(in, base, entry, header, payload)) return false;
+    HistoryBuffer buffer(*this);
+    istream history(&buffer);
+    bool verify = (container.flags & CONTAINER_FLAG_CHECKSUMS) != 0;
+    BlockChecksum checksum;
+    if (!decoder.decode(header, payload.data(), entry.rawOffset, &history, block, verify ? &checksum : nullptr)) {
+        return false;
+    }
+    ++decoded;
+
+    // Step 3: Same checks as a full decode
+    if (verify) {
+        if (checksum.value() != entry.checksum) {
+            cerr << "Checksum mismatch in block at " << entry.rawOffset << ", corrupted file!" << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+const string* ContainerReader::block(size_t index) {
+    if (index >= container.blocks.size()) return nullptr;
+    for (size_t i = 0; i < cache.size(); ++i) {
+        if (cache[i].first == index) {
+            rotate(cache.begin() + i, cache.begin() + i + 1, cache.end());
+            return &cache.back().second;
+        }
+    }
+
+    // Decoding may read earlier blocks through the cache, so the block joins it only afterwards.
+    // It decodes into the buffer of the block it evicts, fresh pages would fault in on every block.
+    string data;
+    if (cache.size() == cacheBlocks) {
+        data.swap(cache.front().second);
+        cache.erase(cache.begin());
+    }
+    if (!decodeBlock(index, data)) return nullptr;
+    cache.push_back(make_pair(index, string()));
+    cache.back().second.swap(data);
+    return &cache.back().second;
+}
+
+bool ContainerReader::read(uint64_t offset, size_t size, char* out) {
+    if (offset > container.originalSize || size > container.originalSize - offset) return false;
+    while (size > 0) {
+        size_t index = findBlock(offset);
+        const string* data = block(index);
+        if (!data) return false;
+        size_t at = static_cast<size_t>(offset - container.blocks[index].rawOffset);
+        size_t n = min(size, data->size() - at);
+        memcpy(out, data->data() + at, n);
+        out += n;
+        offset += n;
+        size -= n;
+    }
+    return true;
+}
+
+bool ContainerReader::read(uint64_t offset, uint64_t size, ostream& out) {
+    if (offset > container.originalSize || size > container.originalSize - offset) return false;
+    while (size > 0) {
+        size_t index = findBlock(offset);
+        const string* data = block(index);
+        if (!data) return false;
+        size_t at = static_cast<size_t>(offset - container.blocks[index].rawOffset);
+        size_t n = static_cast<size_t>(min(size, static_cast<uint64_t>(data->size() - at)));
+        out.write(data->data() + at, n);
+        offset += n;
+        size -= n;
+    }
+    return static_cast<bool>(out);
+}
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Line lookups :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+bool ContainerReader::hasLineIndex() const {
+    for (const pair<uint32_t, string>& section : container.sections) {
+        if (section.first == SECTION_LINE_INDEX) return true;
+    }
+    return false;
+}
+
+bool ContainerReader::loadLines() {
+    if (!linesBefore.empty()) return true;
+
+    // Step 1: The index section, or counting the lines of every block
+    bool indexed = false;
+    for (const pair<uint32_t, string>& section : container.sections) {
+        if (section.first != SECTION_LINE_INDEX) continue;
+        if (!decodeLineIndex(section.second, container.blocks.size(), lines)) {
+            cerr << "Invalid line index, corrupted file!" << endl;
+            return false;
+        }
+        indexed = true;
+    }
+    if (!indexed) {
+        LineCounter counter;
+        lines.clear();
+        for (size_t i = 0; i < container.blocks.size(); ++i) {
+            const string* data = block(i);
+            if (!data) return false;
+            lines.push_back(counter.add(reinterpret_cast<const uint8_t*>(data->data()), data->size()));
+        }
+    }
+
+    // Step 2: Running totals, so the block of a line is a binary search away
+    linesBefore.assign(1, 0);
+    for (const LineEntry& entry : lines) linesBefore.push_back(linesBefore.back() + entry.lines);
+    return true;
+}
+
+bool ContainerReader::lineCount(uint64_t& count) {
+    if (!loadLines()) return false;
+    count = linesBefore.back();
+    return true;
+}
+
+bool ContainerReader::lineStart(uint64_t line, uint64_t& offset) {
+    if (!loadLines() || line == 0 || line > linesBefore.back()) return false;
+    size_t index = static_cast<size_t>(upper_bound(linesBefore.begin(), linesBefore.end(), line - 1) -
+                                       linesBefore.begin()) - 1;
+    const LineEntry& entry = lines[index];
+    uint64_t skip = line - linesBefore[index] - 1;
+
+    // The first line of a block is in the index, later ones are found in the decoded block
+    uint64_t at = entry.firstLine;
+    if (skip > 0) {
+        const string* data = block(index);
+        if (!data || entry.firstLine > data->size()) return false;
+        at += skipLines(reinterpret_cast<const uint8_t*>(data->data()) + entry.firstLine,
+                        data->size() - entry.firstLine, skip);
+    }
+    offset = container.blocks[index].rawOffset + at;
+    return true;
+}
@@ -0,0 +1,68 @@
+#ifndef TXT_SEEK_H
+#define TXT_SEEK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Container_txt.h"
+#include "Lines_txt.h"
+
+/*
+Random access into block based containers. The block table maps every uncompressed offset to
+the block holding it, so a read only decodes the blocks it overlaps, plus
+    - the block carrying the code table, for Huffman blocks that reuse an earlier table
+    - the blocks far matches copy from (--long), decoded on demand in the same way
+A few recently decoded blocks are kept, so neighbouring reads do not decode a block twice.
+Line numbers are mapped to offsets the same way through the line index (see Lines_txt.h).
+*/
+
+const size_t READER_CACHE_BLOCKS = 4;
+
+class ContainerReader {
+public:
+    explicit ContainerReader(std::istream& in, size_t cacheBlocks = READER_CACHE_BLOCKS);
+
+    // Read the header and block table at the current position of in, false if it is no container
+    bool open();
+
+    const ContainerInfo& info() const { return container; }
+
+    // Index of the block holding uncompressed byte offset, the block count past the end
+    size_t findBlock(uint64_t offset) const;
+
+    // Decoded and verified block, valid until the next call. nullptr on errors.
+    const std::string* block(size_t index);
+
+    // Copy uncompressed bytes [offset, offset + size)
+    bool read(uint64_t offset, size_t size, char* out);
+    bool read(uint64_t offset, uint64_t size, std::ostream& out);
+
+    // Blocks decoded so far, cache hits not counted
+    size_t blocksDecoded() const { return decoded; }
+
+    // Line lookups (1-based line numbers) go through the line index section. Files without
+    // one get the same table by decoding every block once.
+    bool hasLineIndex() const;
+    bool lineCount(uint64_t& count);
+
+    // Offset where line starts, false if the data has fewer lines
+    bool lineStart(uint64_t line, uint64_t& offset);
+
+private:
+    std::istream& in;
+    std::streamoff base;
+    ContainerInfo container;
+    std::vector<std::pair<size_t, std::string>> cache; // Most recently used last
+    size_t cacheBlocks;
+    size_t decoded;
+    std::vector<LineEntry> lines;
+    std::vector<uint64_t> linesBefore; // Lines starting before each block, plus the total
+
+    bool loadLines();
+    bool decodeBlock(size_t index, std::string& block);
+};
+
+#endif
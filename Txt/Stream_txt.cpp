@@ -0,0 +1,152 @@
+#include <fstream>
+#include <vector>
+#include "Stream_txt.h"
+#include "Container_txt.h"
+#include "Huffman_txt.h"
+
+using namespace std;
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Function to estimate a table from a (possibly strided) sample :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+static vector<uint32_t> sampleHistogram(const string& data, size_t stride) {
+    vector<uint32_t> hist(256, 0);
+    for (size_t i = 0; i < data.size(); i += stride) {
+        hist[static_cast<unsigned char>(data[i])]++;
+    }
+    return hist;
+}
+
+// Every byte keeps a code, the sample only sees part of the stream
+static vector<uint8_t> lengthsFromHistogram(const vector<uint32_t>& hist) {
+    vector<uint32_t> smoothed(hist);
+    for (uint32_t& f : smoothed) f++;
+    return buildCodeLengths(smoothed, HUFFMAN_MAX_BITS);
+}
+
+static uint64_t tableCost(const vector<uint32_t>& hist, const vector<uint8_t>& lengths) {
+    uint64_t bits = 0;
+    for (size_t s = 0; s < hist.size(); ++s) {
+        bits += static_cast<uint64_t>(hist[s]) * lengths[s];
+    }
+    return bits;
+}
+
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Function to compress a stream in one pass :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+static size_t readSome(istream& in, string& buffer, size_t count) {
+    buffer.resize(count);
+    in.read(&buffer[0], count);
+    buffer.resize(static_cast<size_t>(in.gcount()));
+    return buffer.size();
+}
+
+bool compress_txt_stream(istream& in, ostream& out, const StreamOptions& options) {
+    size_t stride = options.sampleStride ? options.sampleStride : 1;
+    size_t segmentBytes = options.segmentBytes ? options.segmentBytes : 64 * 1024;
+
+    ContainerWriter writer(out, BlockCodec::Huffman, static_cast<uint32_t>(segmentBytes));
+    if (options.lineIndex) writer.indexLines();
+
+    // Step 1: Buffer the sample and build the first table from it
+    string pending;
+    readSome(in, pending, options.sampleBytes ? options.sampleBytes : segmentBytes);
+    if (pending.empty()) {
+        return writer.finish();
+    }
+
+    vector<uint8_t> lengths = lengthsFromHistogram(sampleHistogram(pending, stride));
+    vector<uint32_t> codes = buildCanonicalCodes(lengths);
+    bool tablePending = true;
+    size_t tablesEmitted = 0;
+
+    // Step 2: Encode the sample, then keep reading segment by segment
+    string segment, payload;
+    size_t pendingPos = 0;
+    while (true) {
+        if (pendingPos < pending.size()) {
+            size_t take = min(segmentBytes, pending.size() - pendingPos);
+            segment.assign(pending, pendingPos, take);
+            pendingPos += take;
+        } else {
+            pending.clear();
+            if (readSome(in, segment, segmentBytes) == 0) break;
+
+            // Step 3: Measure how far the current table drifted from this segment
+            vector<uint32_t> hist = sampleHistogram(segment, stride);
+            vector<uint8_t> fresh = lengthsFromHistogram(hist);
+            double current = static_cast<double>(tableCost(hist, lengths));
+            double replaced = static_cast<double>(tableCost(hist, fresh)) + BYTE_TABLE_SIZE * 8.0 / stride;
+            if (current > replaced * (1.0 + options.driftThreshold)) {
+                lengths = fresh;
+                codes = buildCanonicalCodes(lengths);
+                tablePending = true;
+            }
+        }
+
+        // Step 4: Emit the segment, falling back to a stored block if coding does not pay off
+        payload.clear();
+        if (tablePending) writeCodeLengths(payload, lengths);
+        encodeBytes(reinterpret_cast<const uint8_t*>(segment.data()), segment.size(), lengths, codes, payload);
+
+        const uint8_t* raw = reinterpret_cast<const uint8_t*>(segment.data());
+        BlockHeader header = {BlockCodec::Huffman, 0, static_cast<uint32_t>(segment.size()), 0};
+        if (payload.size() >= segment.size()) {
+            header.codec = BlockCodec::Stored;
+            writer.writeBlock(header, segment, raw, segment.size());
+        } else {
+            if (tablePending) {
+                header.flags |= BLOCK_FLAG_TABLE;
+                tablePending = false;
+                ++tablesEmitted;
+            }
+            writer.writeBlock(header, payload, raw, segment.size());
+        }
+        out.flush();
+    }
+
+    bool ok = writer.finish();
+    cout << "Stream compressed with " << tablesEmitted << " code table(s)." << endl;
+    return ok;
+}
+
+/*
+------------------------------------------------------------------------------------------------------------------------------------
+Export Function :
+------------------------------------------------------------------------------------------------------------------------------------
+*/
+
+void compress_txt_stream_file(const string& inputFile, const string& outputFile, const StreamOptions& options) {
+    ofstream outFile(outputFile, ios::out | ios::binary);
+    if (!outFile.is_open()) {
+        cerr << "Error opening output file!" << endl;
+        return;
+    }
+
+    bool ok;
+    if (inputFile == "-") {
+        ok = compress_txt_stream(cin, outFile, options);
+    } else {
+        ifstream inFile(inputFile, ios::in | ios::binary);
+        if (!inFile.is_open()) {
+            cerr << "Error opening input file!" << endl;
+            return;
+        }
+        ok = compress_txt_stream(inFile, outFile, options);
+    }
+
+    if (!ok) {
+        cerr << "Error writing compressed stream!" << endl;
+        return;
+    }
+    cout << "Compression complete. Output written to " << outputFile << endl;
+}
@@ -0,0 +1,34 @@
+#ifndef TXT_STREAM_H
+#define TXT_STREAM_H
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+// One pass Huffman compression for sources that cannot be read twice (stdin, pipes).
+// The first table is estimated from a sample, later tables are only emitted when the
+// current one drifts too far from what the data actually needs.
+struct StreamOptions {
+    size_t sampleBytes;     // Bytes read up front to estimate the first table
+    size_t sampleStride;    // Count every k-th byte when estimating (1 = every byte)
+    size_t segmentBytes;    // Encoding granularity, drift is measured once per segment
+    double driftThreshold;  // Emit a new table once the old one costs this fraction more
+    bool lineIndex;         // Record the line index section (see Lines_txt.h)
+
+    StreamOptions()
+        : sampleBytes(64 * 1024)
+        , sampleStride(1)
+        , segmentBytes(64 * 1024)
+        , driftThreshold(0.05)
+        , lineIndex(false)
+    {
+    }
+};
+
+bool compress_txt_stream(std::istream& in, std::ostream& out, const StreamOptions& options = StreamOptions());
+
+// inputFile "-" reads from stdin
+void compress_txt_stream_file(const std::string& inputFile, const std::string& outputFile,
+                              const StreamOptions& options = StreamOptions());
+
+#endif
@@ -3,8 +3,17 @@
 #include "Jpeg/Libjpeg_lossy/LossyJpegCompressor.h"
 #include "Txt/Compress_txt.h"
 #include "Txt/Decompress_txt.h"
+#include "Txt/Stream_txt.h"
+#include "Txt/Levels_txt.h"
+#include "Txt/Auto_txt.h"
+#include "Txt/Gzip_txt.h"
+#include "Txt/Grep_txt.h"
+#include "Txt/Archive_txt.h"
+#include "Txt/Info_txt.h"
 #include <algorithm>
 #include <cctype>
+#include <cstdint>
+#include <cstdlib>
 #include <string>
 #include <iostream>
 
@@ -15,6 +24,17 @@ int main(int argc, char* argv[]) {
         std::cerr << "Supported file types:\n";
         std::cerr << "  jpeg\n";
         std::cerr << "  txt\n";
+        std::cerr << "Txt compression levels: -0 (stored) ... -19 (strongest), see Txt/Levels_txt.h\n";
+        std::cerr << "Txt auto mode: auto (codec picked per block from sampled statistics)\n";
+        std::cerr << "Txt gzip output: gz [-N] (writes compressed.gz, readable by gzip/zcat)\n";
+        std::cerr << "Txt long distance matching: --long (with a level or auto, finds repeats anywhere in the input)\n";
+        std::cerr << "Txt random access: --range OFFSET:LEN (decodes only the blocks holding those bytes)\n";
+        std::cerr << "Txt line access: --lines FIRST:LAST (1-based), faster on files compressed with --line-index\n";
+        std::cerr << "Txt search: grep PATTERN (prints the matching lines of a compressed file)\n";
+        std::cerr << "Txt metadata: info (header and index only), list (files of an archive)\n";
+        std::cerr << "Txt archives: <directory> txt [-N] [--solid] [--dedup] (packs the tree, extracts to output/)\n";
+        std::cerr << "Txt streaming (file_path - reads stdin):\n";
+        std::cerr << "  --stream [--sample=KB] [--stride=N] [--drift=PERCENT]\n";
         // TODO -> List more supported types here
         return 1;
     }
@@ -22,8 +42,89 @@ int main(int argc, char* argv[]) {
     // Default quality set to 75 if not provided
     int quality = 75;
 
-    if (argc == 4) {
-        quality = atoi(argv[3]);
+    bool decompress = false;
+    bool stream = false;
+    bool autoMode = false;
+    bool longDistance = false;
+    bool gzip = false;
+    bool range = false;
+    bool lineRange = false;
+    bool lineIndex = false;
+    uint64_t rangeOffset = 0, rangeLength = 0;
+    bool grep = false;
+    bool info = false;
+    bool list = false;
+    bool archive = false;
+    bool solid = false;
+    bool dedup = false;
+    std::string pattern;
+    int level = -1;
+    StreamOptions streamOptions;
+
+    // Optional arguments after the file type
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--decompress") {
+            decompress = true;
+        } else if (arg == "--stream") {
+            stream = true;
+        } else if (arg == "auto") {
+            autoMode = true;
+        } else if (arg == "gz") {
+            gzip = true;
+        } else if (arg == "--long") {
+            longDistance = true;
+        } else if (arg == "info") {
+            info = true;
+        } else if (arg == "list") {
+            list = true;
+        } else if (arg == "grep") {
+            if (i + 1 >= argc) {
+                std::cerr << "grep expects a PATTERN\n";
+                return 1;
+            }
+            grep = true;
+            pattern = argv[++i];
+        } else if (arg == "--solid") {
+            solid = true;
+        } else if (arg == "--dedup") {
+            dedup = true;
+        } else if (arg == "--line-index") {
+            lineIndex = true;
+            streamOptions.lineIndex = true;
+        } else if (arg == "--range" || arg == "--lines") {
+            // OFFSET:LEN in bytes of the original data, FIRST:LAST in lines
+            const char* format = arg == "--range" ? "OFFSET:LEN" : "FIRST:LAST";
+            char* end = nullptr;
+            const char* spec = i + 1 < argc ? argv[++i] : "";
+            rangeOffset = std::strtoull(spec, &end, 10);
+            if (end == spec || *end != ':') {
+                std::cerr << arg << " expects " << format << "\n";
+                return 1;
+            }
+            const char* lengthSpec = end + 1;
+            rangeLength = std::strtoull(lengthSpec, &end, 10);
+            if (end == lengthSpec || *end != '\0') {
+                std::cerr << arg << " expects " << format << "\n";
+                return 1;
+            }
+            range = arg == "--range";
+            lineRange = arg == "--lines";
+        } else if (arg.size() > 1 && arg[0] == '-' && std::isdigit(static_cast<unsigned char>(arg[1]))) {
+            level = atoi(arg.c_str() + 1);
+            if (level < MIN_LEVEL || level > MAX_LEVEL) {
+                std::cerr << "Compression level must be between " << MIN_LEVEL << " and " << MAX_LEVEL << "\n";
+                return 1;
+            }
+        } else if (arg.compare(0, 9, "--sample=") == 0) {
+            streamOptions.sampleBytes = static_cast<size_t>(atoi(arg.c_str() + 9)) * 1024;
+        } else if (arg.compare(0, 9, "--stride=") == 0) {
+            streamOptions.sampleStride = static_cast<size_t>(atoi(arg.c_str() + 9));
+        } else if (arg.compare(0, 8, "--drift=") == 0) {
+            streamOptions.driftThreshold = atof(arg.c_str() + 8) / 100.0;
+        } else {
+            quality = atoi(arg.c_str());
+        }
     }
 
     const char * filePath = argv[1];
@@ -46,9 +147,20 @@ int main(int argc, char* argv[]) {
     }
 
     // In a try catch block to handle exceptions thrown by the FileTypeValidator
+    // stdin ("-") cannot be inspected without consuming it, so it is not validated
     try {
-        bool isValid = validateFileType(filePath, expectedType);
-        if (isValid || std::string(argv[3]) == "--decompress") {
+        // Compressed containers are decompressed without needing --decompress, directories are archived
+        if (expectedType == FileType::TXT && std::string(filePath) != "-" &&
+            validateFileType(filePath, FileType::DIRECTORY)) {
+            archive = true;
+        } else if (expectedType == FileType::TXT && std::string(filePath) != "-" &&
+            validateFileType(filePath, FileType::COMPRESSED)) {
+            decompress = true;
+        }
+        bool isValid = std::string(filePath) == "-" || validateFileType(filePath, expectedType);
+        if (archive) {
+            std::cout << "The path is a directory, packing it into an archive.\n";
+        } else if (isValid || decompress) {
             std::cout << "The file is a valid " << fileTypeStr << " file.\n";
         } else {
             std::cout << "The file is NOT a valid " << fileTypeStr << " file.\n";
@@ -62,9 +174,39 @@ int main(int argc, char* argv[]) {
         // Compress txt file
         const std::string inputFile = filePath;
 
-        if (argc == 4 && std::string(argv[3]) == "--decompress") {
+        if (archive) {
+            const std::string outputFile = "compressed.bin";
+            compress_txt_archive(inputFile, outputFile, level >= 0 ? level : ARCHIVE_DEFAULT_LEVEL, solid, dedup);
+        } else if (info) {
+            if (!info_txt_file(inputFile)) return 1;
+        } else if (list) {
+            if (!list_txt_archive(inputFile)) return 1;
+        } else if (grep) {
+            if (!grep_txt_file(inputFile, pattern)) return 1;
+        } else if (range) {
             const std::string outputFile = "output.txt";
-            decompress_txt_file(inputFile, outputFile);
+            if (!decompress_txt_range(inputFile, outputFile, rangeOffset, rangeLength)) return 1;
+        } else if (lineRange) {
+            const std::string outputFile = "output.txt";
+            if (!decompress_txt_lines(inputFile, outputFile, rangeOffset, rangeLength)) return 1;
+        } else if (decompress && isTxtArchive(inputFile)) {
+            const std::string outputDir = "output";
+            if (!extract_txt_archive(inputFile, outputDir)) return 1;
+        } else if (decompress) {
+            const std::string outputFile = "output.txt";
+            if (!decompress_txt_file(inputFile, outputFile)) return 1;
+        } else if (stream || inputFile == "-") {
+            const std::string outputFile = "compressed.bin";
+            compress_txt_stream_file(inputFile, outputFile, streamOptions);
+        } else if (gzip) {
+            const std::string outputFile = "compressed.gz";
+            compress_txt_gzip_file(inputFile, outputFile, level);
+        } else if (autoMode) {
+            const std::string outputFile = "compressed.bin";
+            compress_txt_auto(inputFile, outputFile, longDistance, lineIndex);
+        } else if (level >= 0) {
+            const std::string outputFile = "compressed.bin";
+            compress_txt_level(inputFile, outputFile, level, longDistance, lineIndex);
         } else {
             const std::string outputFile = "compressed.bin";
             compress_txt_file(inputFile, outputFile);